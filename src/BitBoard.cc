@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <memory>
 #include <numeric>
+#include <sstream>
 #include "ChessSquares.h"
 #include "BitBoard.h"
 #include "Masks.h"
@@ -14,6 +15,44 @@ const int BISHOP_VALUE = 300;
 const int KNIGHT_VALUE = 300;
 const int PAWN_VALUE = 100;
 
+// the values above, by piece offset (see the `Piece` enum)
+static const int pieceOffsetValues[6] = {KING_VALUE, QUEEN_VALUE, BISHOP_VALUE, KNIGHT_VALUE, ROOK_VALUE, PAWN_VALUE};
+
+// returns the position bonus of a piece with offset `pieceOffset` for the player with offset `playerOffset`
+static int getPositionBonus(const int pieceOffset, const int playerOffset, const int position)
+{
+    switch (pieceOffset) {
+    case Piece::Q:
+        return Masks::queenPositionBonus[playerOffset / 6][position];
+    case Piece::B:
+        return Masks::bishopPositionBonus[playerOffset / 6][position];
+    case Piece::N:
+        return Masks::knightPositionBonus[playerOffset / 6][position];
+    case Piece::R:
+        return Masks::rookPositionBonus[playerOffset / 6][position];
+    default:
+        return 0;
+    }
+}
+
+inline void BitBoard::setTemporalInfo(uint32_t newTemporalInfo)
+{
+    // castling needs both the king's bit and a rook's bit, so once either side of that is gone the other no longer matters.
+    // clearing it keeps one encoding (and so one hash key and one FEN string) for each position.
+    if (!(newTemporalInfo & 0x100000u) || !(newTemporalInfo & 0x30000u)) {
+        newTemporalInfo &= ~0x130000u;
+    }
+    if (!(newTemporalInfo & 0x200000u) || !(newTemporalInfo & 0xC0000u)) {
+        newTemporalInfo &= ~0x2C0000u;
+    }
+    uint32_t changedBits = temporalInfo ^ newTemporalInfo;
+    while (changedBits > 0) {
+        hashKey ^= zobrist.temporalKeys[std::countr_zero(changedBits)];
+        changedBits &= changedBits - 1;
+    }
+    temporalInfo = newTemporalInfo;
+}
+
 inline bool BitBoard::isWhitePawnEnpassantable(const unsigned file) const
 {
     return temporalInfo & (1u << file);
@@ -26,17 +65,17 @@ inline bool BitBoard::isBlackPawnEnpassantable(const unsigned file) const
 
 inline void BitBoard::setWhitePawnEnpassantable(const unsigned file)
 {
-    temporalInfo |= (1u << file);
+    setTemporalInfo(temporalInfo | (1u << file));
 }
 
 inline void BitBoard::setBlackPawnEnpassantable(const unsigned file)
 {
-    temporalInfo |= (0x100u << file);
+    setTemporalInfo(temporalInfo | (0x100u << file));
 }
 
 inline void BitBoard::resetEnpassantFlags()
 {
-    temporalInfo &= ~(0xFFFFu);
+    setTemporalInfo(temporalInfo & ~(0xFFFFu));
 }
 
 inline bool BitBoard::isWhiteLeftCastleable() const
@@ -61,32 +100,32 @@ inline bool BitBoard::isBlackRightCastleable() const
 
 inline void BitBoard::setWhiteKingMoved()
 {
-    temporalInfo &= ~0x100000u;
+    setTemporalInfo(temporalInfo & ~0x100000u);
 }
 
 inline void BitBoard::setBlackKingMoved()
 {
-    temporalInfo &= ~0x200000u;
+    setTemporalInfo(temporalInfo & ~0x200000u);
 }
 
 inline void BitBoard::setWhiteLeftRookMoved()
 {
-    temporalInfo &= ~0x10000u;
+    setTemporalInfo(temporalInfo & ~0x10000u);
 }
 
 inline void BitBoard::setWhiteRightRookMoved()
 {
-    temporalInfo &= ~0x20000u;
+    setTemporalInfo(temporalInfo & ~0x20000u);
 }
 
 inline void BitBoard::setBlackRightRookMoved()
 {
-    temporalInfo &= ~0x40000u;
+    setTemporalInfo(temporalInfo & ~0x40000u);
 }
 
 inline void BitBoard::setBlackLeftRookMoved()
 {
-    temporalInfo &= ~0x80000u;
+    setTemporalInfo(temporalInfo & ~0x80000u);
 }
 
 inline int BitBoard::getCurrentPlayerOffset() const
@@ -101,7 +140,7 @@ inline int BitBoard::getOtherPlayerOffset() const
 
 inline void BitBoard::swapCurrentPlayer()
 {
-    temporalInfo ^= 0x400000u;
+    setTemporalInfo(temporalInfo ^ 0x400000u);
 }
 
 std::vector<Piece> BitBoard::getPieceList() const
@@ -195,152 +234,61 @@ inline U64 BitBoard::getPlayerCombinedPieceMask(const Player player) const
     return mask;
 }
 
-void BitBoard::useRayMask(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, const std::vector<U64>& masks)
+inline U64 BitBoard::candidateBishopMoves(const Position position, const U64 occupiedMask, const Masks& masks)
 {
-    const U64 combinedMask = friendMask | enemyMask;
-    
-    // cast ray
-    for (auto mask : masks) {
-        
-        // this means there was a collision
-        if (combinedMask & mask) {
-
-            // this means it collided with an enemy piece, so it is a candidate for a legal attacking move
-            if (mask & enemyMask) {
-                captureMoves.push_back({position, std::countr_zero(mask)});
-            }
-            return;
-        
-        // this means there was no collision, so it is a candidate to be a valid `moving` move.
-        } else {
-            nonCaptureMoves.push_back({position, std::countr_zero(mask)});
-        }
-    }
+    return masks.bishopAttacks(position.position, occupiedMask);
 }
 
-inline void BitBoard::checkRayForCheck(std::vector<Position>& enemyChecks, const U64 nonhostileMask, const U64 attackingEnemyMask, const std::vector<U64>& masks)
+inline U64 BitBoard::candidateRookMoves(const Position position, const U64 occupiedMask, const Masks& masks)
 {
-    const U64 combinedMask = nonhostileMask | attackingEnemyMask;
-
-    // cast ray
-    for (auto mask : masks) {
-        
-        // this means there was a collision
-        if (mask & combinedMask) {
-
-            // this means it collided with an enemy piece, so it is a candidate for a legal attacking move
-            if (mask & attackingEnemyMask) {
-
-                enemyChecks.push_back(std::countr_zero(mask));
-            } 
-            return;
-        } 
-    }
+    return masks.rookAttacks(position.position, occupiedMask);
 }
 
-
-inline void BitBoard::candidateBishopMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks)
+inline U64 BitBoard::candidateQueenMoves(const Position position, const U64 occupiedMask, const Masks& masks)
 {
-    useRayMask(nonCaptureMoves, captureMoves, position, friendMask, enemyMask, masks->attackRayDiagonalUpRight[position.position]);
-    useRayMask(nonCaptureMoves, captureMoves, position, friendMask, enemyMask, masks->attackRayDiagonalUpLeft[position.position]);
-    useRayMask(nonCaptureMoves, captureMoves, position, friendMask, enemyMask, masks->attackRayDiagonalDownRight[position.position]);
-    useRayMask(nonCaptureMoves, captureMoves, position, friendMask, enemyMask, masks->attackRayDiagonalDownLeft[position.position]);
+    return masks.queenAttacks(position.position, occupiedMask);
 }
 
-inline void BitBoard::candidateRookMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks)
+inline U64 BitBoard::pawnSinglePushes(const U64 pawns, const U64 emptyMask, const bool isWhite)
 {
-    useRayMask(nonCaptureMoves, captureMoves, position, friendMask, enemyMask, masks->attackRayRight[position.position]);
-    useRayMask(nonCaptureMoves, captureMoves, position, friendMask, enemyMask, masks->attackRayUp[position.position]);
-    useRayMask(nonCaptureMoves, captureMoves, position, friendMask, enemyMask, masks->attackRayLeft[position.position]);
-    useRayMask(nonCaptureMoves, captureMoves, position, friendMask, enemyMask, masks->attackRayDown[position.position]);
+    return (isWhite ? pawns << 8 : pawns >> 8) & emptyMask;
 }
 
-inline void BitBoard::candidateQueenMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks)
+inline U64 BitBoard::pawnDoublePushes(const U64 singlePushes, const U64 emptyMask, const bool isWhite, const Masks& masks)
 {
-    candidateBishopMoves(nonCaptureMoves, captureMoves, position, friendMask, enemyMask, masks);
-    candidateRookMoves(nonCaptureMoves, captureMoves, position, friendMask, enemyMask, masks);
+    // a pawn that could step onto the third rank (from its own side) started on its starting rank, so it can step again
+    return isWhite ? ((singlePushes & masks.rankMasks[A3]) << 8) & emptyMask : ((singlePushes & masks.rankMasks[A6]) >> 8) & emptyMask;
 }
 
-inline void BitBoard::candidatePawnMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, const U64 attackMask, const U64 moveMask) const
+inline U64 BitBoard::pawnWestCaptures(const U64 pawns, const bool isWhite, const Masks& masks)
 {
-    // First, we find moves that don't take pieces
-    U64 possibleMoves = moveMask & ~(friendMask | enemyMask);
-    
-    // we can only move if it is not the case that we can do a double move, where the piece adjacent to this pawn is blocked, 
-    // but the tile beyond it isn't
-    if (!(std::popcount(moveMask) == 2 && std::popcount(possibleMoves) == 1 && abs(std::countr_zero(possibleMoves)-position.position) > 8)) {
-        while (possibleMoves > 0) {
-            nonCaptureMoves.push_back({position, std::countr_zero(possibleMoves)});
-            possibleMoves &= ~(1ull << std::countr_zero(possibleMoves));
-        }
-    }
-
-    // check attacking moves
-    possibleMoves = attackMask & enemyMask; // can only attack enemies
-    while (possibleMoves > 0) {
-        captureMoves.push_back({position, std::countr_zero(possibleMoves)});
-        possibleMoves &= ~(1ull << std::countr_zero(possibleMoves));
-    }
+    // pawns on the A file have nothing to their west, and would wrap around to the H file
+    const U64 capturingPawns = pawns & masks.fileNotMasks[A1];
+    return isWhite ? capturingPawns << 7 : capturingPawns >> 9;
 }
 
-inline void BitBoard::candidateWhitePawnMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks) const
+inline U64 BitBoard::pawnEastCaptures(const U64 pawns, const bool isWhite, const Masks& masks)
 {
-    // Get a mask that puts any black pawns that just double-moved onto the spot
-    // where they would have been if they had single moved, so that this pawn can
-    // en passant them
-    const U64 enPassantMask = ((temporalInfo & 0xFF00ull) << 32);
-    candidatePawnMoves(nonCaptureMoves, captureMoves, position, friendMask, enemyMask | enPassantMask, masks->whitePawnAttackMasks[position.position], masks->whitePawnMoveMasks[position.position]);
+    const U64 capturingPawns = pawns & masks.fileNotMasks[H1];
+    return isWhite ? capturingPawns << 9 : capturingPawns >> 7;
 }
 
-inline void BitBoard::candidateBlackPawnMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks) const
+inline U64 BitBoard::getEnPassantMask(const bool isWhite) const
 {
-    // Get a mask that puts any white pawns that just double-moved onto the spot
-    // where they would have been if they had single moved, so that this pawn can
+    // Get a mask that puts any enemy pawns that just double-moved onto the spot
+    // where they would have been if they had single moved, so that our pawns can
     // en passant them
-    const U64 enPassantMask = ((temporalInfo & 0xFFu) << 16);
-    candidatePawnMoves(nonCaptureMoves, captureMoves, position, friendMask, enemyMask | enPassantMask, masks->blackPawnAttackMasks[position.position], masks->blackPawnMoveMasks[position.position]);
-}
-
-inline void BitBoard::candidateKnightMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks)
-{
-    U64 possibleMoves = masks->knightAttackMasks[position.position] & ~friendMask; // can't move to where a friendly piece is
-    while (possibleMoves > 0) {
-        const int newPosition = std::countr_zero(possibleMoves);
-        if (enemyMask & (1ull << newPosition)) {
-            captureMoves.push_back({position, newPosition});
-        } else {
-            nonCaptureMoves.push_back({position, newPosition});
-        }
-        possibleMoves &= ~(1ull << newPosition);
-    }
+    return isWhite ? ((temporalInfo & 0xFF00ull) << 32) : ((temporalInfo & 0xFFu) << 16);
 }
 
-inline void BitBoard::candidateKingMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks)
-{
-    U64 possibleMoves = masks->kingAttackMasks[position.position] & ~friendMask; // can't move to where a friendly piece is
-    while (possibleMoves > 0) {
-        const int newPosition = std::countr_zero(possibleMoves);
-        if (enemyMask & (1ull << newPosition)) {
-            captureMoves.push_back({position, newPosition});
-        } else {
-            nonCaptureMoves.push_back({position, newPosition});
-        }
-        possibleMoves &= ~(1ull << newPosition);
-    }
-}
-
-inline void BitBoard::checkForKnightChecks(std::vector<Position>& enemyChecks, const Position position, const U64 enemyMask, shared_ptr<Masks> masks) const
+inline void BitBoard::checkForKnightChecks(U64& enemyChecks, const Position position, const U64 enemyMask, const Masks& masks) const
 {
     // `& enemyMask` is so that if we are using this method in `isKingInCheck`, for checking if a move took the king out of check
     // by killing a knight that was putting our king in check, we don't count the knight that was killed
-    U64 possibleKnightAttacks = masks->knightAttackMasks[position.position] & pieces[getOtherPlayerOffset() + Piece::N] & enemyMask;
-    while (possibleKnightAttacks > 0) {
-        enemyChecks.push_back(std::countr_zero(possibleKnightAttacks));
-        possibleKnightAttacks &= ~(1ull << std::countr_zero(possibleKnightAttacks));
-    }
+    enemyChecks |= masks.knightAttackMasks[position.position] & pieces[getOtherPlayerOffset() + Piece::N] & enemyMask;
 }
 
-inline void BitBoard::checkForHorizontalVerticalChecks(std::vector<Position>& enemyChecks, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks) const
+inline void BitBoard::checkForHorizontalVerticalChecks(U64& enemyChecks, const Position position, const U64 friendMask, const U64 enemyMask, const Masks& masks) const
 {
     const int otherPlayerOffset = getOtherPlayerOffset();
 
@@ -349,65 +297,58 @@ inline void BitBoard::checkForHorizontalVerticalChecks(std::vector<Position>& en
     // by killing a rook/queen that was putting our king in check, we don't count the piece that was killed
    
     const U64 hostileEnemyMask = (pieces[otherPlayerOffset + Piece::Q] | pieces[otherPlayerOffset + Piece::R]) & enemyMask;
-    const U64 nonhostileEnemyMask = enemyMask & ~(hostileEnemyMask);
 
-    checkRayForCheck(enemyChecks, (friendMask | nonhostileEnemyMask), hostileEnemyMask, masks->attackRayRight[position.position]);
-    checkRayForCheck(enemyChecks, (friendMask | nonhostileEnemyMask), hostileEnemyMask, masks->attackRayUp[position.position]);
-    checkRayForCheck(enemyChecks, (friendMask | nonhostileEnemyMask), hostileEnemyMask, masks->attackRayLeft[position.position]);
-    checkRayForCheck(enemyChecks, (friendMask | nonhostileEnemyMask), hostileEnemyMask, masks->attackRayDown[position.position]);
+    // cast rook rays out from `position`; any hostile piece they collide with first is giving check
+    enemyChecks |= masks.rookAttacks(position.position, friendMask | enemyMask) & hostileEnemyMask;
 }
 
-inline void BitBoard::checkForDiagonalChecks(std::vector<Position>& enemyChecks, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks) const
+inline void BitBoard::checkForDiagonalChecks(U64& enemyChecks, const Position position, const U64 friendMask, const U64 enemyMask, const Masks& masks) const
 {
     const int otherPlayerOffset = getOtherPlayerOffset();
 
     // get the enemy pawns that could potentially attack the piece at `position`. These are equivalently the pawns that `position` could attack, if it were itself a pawn.
     // ternary operator case explanation: if the other player offset is 0, then we are black. Otherwise, we are white.
-    const U64 potentialPawnAttacks = pieces[otherPlayerOffset + Piece::P] & ((otherPlayerOffset == Player::White) ? masks->blackPawnAttackMasks[position.position] : masks->whitePawnAttackMasks[position.position]);
+    const U64 potentialPawnAttacks = pieces[otherPlayerOffset + Piece::P] & ((otherPlayerOffset == Player::White) ? masks.blackPawnAttackMasks[position.position] : masks.whitePawnAttackMasks[position.position]);
     
-    // only consider bishops and queens (only they can attack horizontally and vertically)
+    // only consider bishops and queens (only they can attack diagonally from afar)
     // `& enemyMask` is so that if we are using this method in `isKingInCheck`, for checking if a move takes the king out of check
     // by killing a rook/queen/pawn that was putting our king in check, we don't count the piece that was killed
-    const U64 hostileEnemyMask = (pieces[otherPlayerOffset+Piece::Q] | pieces[otherPlayerOffset+Piece::B] | potentialPawnAttacks) & enemyMask;
-    const U64 nonhostileEnemyMask = enemyMask & ~(hostileEnemyMask);
+    const U64 hostileEnemyMask = (pieces[otherPlayerOffset+Piece::Q] | pieces[otherPlayerOffset+Piece::B]) & enemyMask;
 
-    checkRayForCheck(enemyChecks, (friendMask | nonhostileEnemyMask), hostileEnemyMask, masks->attackRayDiagonalUpRight[position.position]);
-    checkRayForCheck(enemyChecks, (friendMask | nonhostileEnemyMask), hostileEnemyMask, masks->attackRayDiagonalUpLeft[position.position]);
-    checkRayForCheck(enemyChecks, (friendMask | nonhostileEnemyMask), hostileEnemyMask, masks->attackRayDiagonalDownLeft[position.position]);
-    checkRayForCheck(enemyChecks, (friendMask | nonhostileEnemyMask), hostileEnemyMask, masks->attackRayDiagonalDownRight[position.position]);
+    // cast bishop rays out from `position`; any hostile piece they collide with first is giving check.
+    // the pawns don't need a ray since they can only attack from an adjacent tile.
+    enemyChecks |= (masks.bishopAttacks(position.position, friendMask | enemyMask) & hostileEnemyMask) | (potentialPawnAttacks & enemyMask);
 }
 
-inline void BitBoard::checkForEnemyKingChecks(std::vector<Position>& enemyChecks, const Position yourKingPosition, shared_ptr<Masks> masks) const
+inline void BitBoard::checkForEnemyKingChecks(U64& enemyChecks, const Position yourKingPosition, const Masks& masks) const
 {
-    const int otherPlayerOffset = getOtherPlayerOffset();
-
-    const int enemyKingPosition = std::countr_zero(pieces[otherPlayerOffset + Piece::K]);
-    if (masks->kingAttackMasks[enemyKingPosition] & (1ull << yourKingPosition.position)) {
-        enemyChecks.push_back(enemyKingPosition);
+    const U64 enemyKing = pieces[getOtherPlayerOffset() + Piece::K];
+    if (masks.kingAttackMasks[yourKingPosition.position] & enemyKing) {
+        enemyChecks |= enemyKing;
     }
 }
 
 // precondition; requires both kings to be on the board
 // `kinglessFriendMask` should not have your king in it. The king's position should only taken into account by `kingPosition`
-inline bool BitBoard::isKingInCheck(const Position kingPosition, const U64 kinglessFriendMask, const U64 enemyMask, shared_ptr<Masks> masks) const
+inline bool BitBoard::isKingInCheck(const Position kingPosition, const U64 kinglessFriendMask, const U64 enemyMask, const Masks& masks) const
 {
-    std::vector<Position> enemyCheckingPieces;
+    U64 enemyCheckingPieces = 0ull;
     
     // check enemy queens and rooks
     checkForHorizontalVerticalChecks(enemyCheckingPieces, kingPosition, kinglessFriendMask, enemyMask, masks);
-    if (enemyCheckingPieces.size()) return true;
+    if (enemyCheckingPieces) return true;
     
     // check enemy queens, bishops, and pawns
     checkForDiagonalChecks(enemyCheckingPieces, kingPosition, kinglessFriendMask, enemyMask, masks);
-    if (enemyCheckingPieces.size()) return true;
+    if (enemyCheckingPieces) return true;
     
     // check enemy knights
     checkForKnightChecks(enemyCheckingPieces, kingPosition, enemyMask, masks);
-    if (enemyCheckingPieces.size()) return true;
+    if (enemyCheckingPieces) return true;
 
     // check enemy king
     checkForEnemyKingChecks(enemyCheckingPieces, kingPosition, masks);
-    return enemyCheckingPieces.size();
+    return enemyCheckingPieces;
 }
 
 inline int BitBoard::findPieceOffset(const Position position, const int playerOffset) const
@@ -420,10 +361,45 @@ inline int BitBoard::findPieceOffset(const Position position, const int playerOf
     return -1;
 }
 
-inline void BitBoard::movePiece(U64& tile, const Move& m)
+inline void BitBoard::updatePieceScores(const int piece, const int position, const int sign)
 {
-    tile &= ~(1ull << m.start.position);
-    tile |= (1ull << m.end.position);
+    const int side = piece / 6;
+    const int pieceOffset = piece % 6;
+    pieceScores.material[side] += sign * pieceOffsetValues[pieceOffset];
+    pieceScores.positionBonuses[side][pieceOffset] += sign * getPositionBonus(pieceOffset, side * 6, position);
+}
+
+inline void BitBoard::movePiece(const int piece, const Move& m)
+{
+    pieces[piece] &= ~(1ull << m.start.position);
+    pieces[piece] |= (1ull << m.end.position);
+    hashKey ^= zobrist.pieceKeys[piece][m.start.position] ^ zobrist.pieceKeys[piece][m.end.position];
+    const int pieceOffset = piece % 6;
+    if (pieceOffset == Piece::P) {
+        pawnKey ^= zobrist.pieceKeys[piece][m.start.position] ^ zobrist.pieceKeys[piece][m.end.position];
+    }
+    pieceScores.positionBonuses[piece / 6][pieceOffset] += getPositionBonus(pieceOffset, piece - pieceOffset, m.end.position)
+                                                         - getPositionBonus(pieceOffset, piece - pieceOffset, m.start.position);
+}
+
+inline void BitBoard::placePiece(const int piece, const int position)
+{
+    pieces[piece] |= (1ull << position);
+    hashKey ^= zobrist.pieceKeys[piece][position];
+    if (piece % 6 == Piece::P) {
+        pawnKey ^= zobrist.pieceKeys[piece][position];
+    }
+    updatePieceScores(piece, position, 1);
+}
+
+inline void BitBoard::capturePiece(const int piece, const int position)
+{
+    pieces[piece] &= ~(1ull << position);
+    hashKey ^= zobrist.pieceKeys[piece][position];
+    if (piece % 6 == Piece::P) {
+        pawnKey ^= zobrist.pieceKeys[piece][position];
+    }
+    updatePieceScores(piece, position, -1);
 }
 
 inline void BitBoard::applyKingMove(const Move& move)
@@ -432,11 +408,7 @@ inline void BitBoard::applyKingMove(const Move& move)
 
     resetEnpassantFlags();
 
-    pieces[currentPlayerOffset + Piece::K] = (1ull << move.end.position);
-    const int enemyPieceOffset = findPieceOffset(move.end, getOtherPlayerOffset());
-    if (enemyPieceOffset != -1) {
-        pieces[getOtherPlayerOffset() + enemyPieceOffset] &= ~(1ull << move.end.position);
-    }
+    movePiece(currentPlayerOffset + Piece::K, move);
     if (currentPlayerOffset == 0) {
         setWhiteKingMoved();
     } else {
@@ -451,13 +423,7 @@ inline void BitBoard::applyQueenMove(const Move& move)
     resetEnpassantFlags();
 
     // put the queen at her new place
-    movePiece(pieces[currentPlayerOffset + Piece::Q], move);
-
-    // check if this was a capturing move. If it was, then remove the opponent's piece
-    const int enemyPieceOffset = findPieceOffset(move.end, getOtherPlayerOffset());
-    if (enemyPieceOffset != -1) {
-        pieces[getOtherPlayerOffset() + enemyPieceOffset] &= ~(1ull << move.end.position);
-    }
+    movePiece(currentPlayerOffset + Piece::Q, move);
 }
 
 inline void BitBoard::applyBishopMove(const Move& move)
@@ -467,14 +433,7 @@ inline void BitBoard::applyBishopMove(const Move& move)
     resetEnpassantFlags();
 
     // put the bishop at her new place
-    movePiece(pieces[currentPlayerOffset + Piece::B], move);
-
-
-    // check if this was a capturing move. If it was, then remove the opponent's piece
-    const int enemyPieceOffset = findPieceOffset(move.end, getOtherPlayerOffset());
-    if (enemyPieceOffset != -1) {
-        pieces[getOtherPlayerOffset()+enemyPieceOffset] &= ~(1ull << move.end.position);
-    }
+    movePiece(currentPlayerOffset + Piece::B, move);
 }
 
 void BitBoard::applyKnightMove(const Move& move)
@@ -484,13 +443,7 @@ void BitBoard::applyKnightMove(const Move& move)
     resetEnpassantFlags();
 
     // put the knight at his new place
-    movePiece(pieces[currentPlayerOffset + Piece::N], move);
-
-    // check if this was a capturing move. If it was, then remove the opponent's piece
-    const int enemyPieceOffset = findPieceOffset(move.end, getOtherPlayerOffset());
-    if (enemyPieceOffset != -1) {
-        pieces[getOtherPlayerOffset() + enemyPieceOffset] &= ~(1ull << move.end.position);
-    }
+    movePiece(currentPlayerOffset + Piece::N, move);
 }
 
 inline void BitBoard::applyRookMove(const Move& move)
@@ -500,14 +453,7 @@ inline void BitBoard::applyRookMove(const Move& move)
     resetEnpassantFlags();
 
     // put the rook at its new place
-    movePiece(pieces[currentPlayerOffset + Piece::R], move);
-
-
-    // check if this was a capturing move. If it was, then remove the opponent's piece
-    const int enemyPieceOffset = findPieceOffset(move.end, getOtherPlayerOffset());
-    if (enemyPieceOffset != -1) {
-        pieces[getOtherPlayerOffset() + enemyPieceOffset] &= ~(1ull << move.end.position);
-    } 
+    movePiece(currentPlayerOffset + Piece::R, move);
 
     // update flags for castleability
     if (currentPlayerOffset == Player::White) {
@@ -532,20 +478,7 @@ inline void BitBoard::applyPawnMove(const Move& move)
     resetEnpassantFlags();
 
     // put the pawn at its new place
-    movePiece(pieces[currentPlayerOffset + Piece::P], move);
-
-    // check if this was a normal capturing move. If it was, then remove the opponent's piece
-    const int enemyPlayerOffset = getOtherPlayerOffset();
-    const int enemyPieceOffset = findPieceOffset(move.end, enemyPlayerOffset);
-    if (enemyPieceOffset != -1) {
-        pieces[enemyPlayerOffset + enemyPieceOffset] &= ~(1ull << move.end.position);
-    
-    // check if this was an en passant attack. That will be when the attacking pawn moved off of its file,
-    // yet there was no piece there.
-    } else if (move.end.getFile() != move.start.getFile()) {
-        const int enemyPosition = move.start.getRank()*8 + move.end.getFile();
-        pieces[enemyPlayerOffset + Piece::P] &= ~(1ull << enemyPosition);
-    }
+    movePiece(currentPlayerOffset + Piece::P, move);
 
     // apply the enpassant flag
     if (abs(move.start.position - move.end.position) == 16) {
@@ -559,7 +492,7 @@ inline void BitBoard::applyPawnMove(const Move& move)
 
 // precondition: king and rook are on the same rank, and both exist at the positions specified
 // precondition: king is not in check at their initial location
-inline bool BitBoard::checkCastleable(const int kingPosition, const int rookPosition, const U64 friendMask, const U64 enemyMask, std::shared_ptr<Masks> masks) const
+inline bool BitBoard::checkCastleable(const int kingPosition, const int rookPosition, const U64 friendMask, const U64 enemyMask, const Masks& masks) const
 {
     // make sure the rook exists at the spot it says it does
     const int currentPlayerOffset = getCurrentPlayerOffset();
@@ -604,248 +537,642 @@ inline bool BitBoard::checkCastleable(const int kingPosition, const int rookPosi
     return true;
 }
 
-inline void BitBoard::applyAllPawnMoves(std::vector<std::shared_ptr<BitBoard>>& result, std::vector<Move>& moves, const int kingPosition, const U64 friendMask, const U64 enemyMask, std::shared_ptr<Masks> masks) const
+inline void BitBoard::addMoves(MoveList& moveList, const int start, U64 targets, const int flags)
 {
-    for (auto& m : moves) {
-        const U64 newFriendMask = (friendMask & ~(1ull << m.start.position)) | (1ull << m.end.position);
-        const U64 newEnemyMask = enemyMask & ~(1ull << m.end.position);
-        if (!isKingInCheck(kingPosition, newFriendMask, newEnemyMask, masks)) {
+    while (targets > 0) {
+        moveList.push({start, std::countr_zero(targets), flags});
+        targets &= targets - 1;
+    }
+}
 
-            // promotion pawn move.
-            if (m.end.getRank() == 0 || m.end.getRank() == 7) {
-                std::vector<Piece> promotionPieces = {Piece(Piece::Q), Piece(Piece::N), Piece(Piece::R), Piece(Piece::B)};
-                
-                for (auto piece : promotionPieces) {
-                    auto newBoard = result.emplace_back(make_unique<BitBoard>(*this));
-                    newBoard->applyPawnMove(m);
-                    newBoard->pieces[getCurrentPlayerOffset() + Piece::P] &= ~(1ull << m.end.position);
-                    newBoard->pieces[getCurrentPlayerOffset() + piece] |= (1ull << m.end.position);
-                    newBoard->swapCurrentPlayer();
-                }
-                
-            // non-promotion pawn move
-            } else {
-                auto newBoard = result.emplace_back(make_unique<BitBoard>(*this));
-                newBoard->applyPawnMove(m);
-                newBoard->swapCurrentPlayer();
-            }
+inline void BitBoard::addPawnTargets(MoveList& moveList, U64 targets, const int delta, const int flags)
+{
+    const bool capture = flags & PackedMove::Capture;
+    while (targets > 0) {
+        const int end = std::countr_zero(targets);
+        const int start = end - delta;
+
+        // promotion pawn move.
+        if (Position(end).getRank() == 0 || Position(end).getRank() == 7) {
+            moveList.push(PackedMove::promotion(start, end, Piece::Q, capture));
+            moveList.push(PackedMove::promotion(start, end, Piece::N, capture));
+            moveList.push(PackedMove::promotion(start, end, Piece::R, capture));
+            moveList.push(PackedMove::promotion(start, end, Piece::B, capture));
+
+        // non-promotion pawn move
+        } else {
+            moveList.push({start, end, flags});
         }
+        targets &= targets - 1;
     }
 }
 
-inline void BitBoard::applyAllBishopMoves(std::vector<std::shared_ptr<BitBoard>>& result, std::vector<Move>& moves, const int kingPosition, const U64 friendMask, const U64 enemyMask, std::shared_ptr<Masks> masks) const
+inline void BitBoard::addEnPassantMoves(MoveList& moveList, U64 targets, const int delta, const int kingPosition, const U64 friendMask, const U64 enemyMask, const Masks& masks) const
 {
-    for (auto& m : moves) {
-        const U64 newFriendMask = (friendMask & ~(1ull << m.start.position)) | (1ull << m.end.position);
-        const U64 newEnemyMask = enemyMask & ~(1ull << m.end.position);
+    while (targets > 0) {
+        const int end = std::countr_zero(targets);
+        const int start = end - delta;
+        const U64 newFriendMask = (friendMask & ~(1ull << start)) | (1ull << end);
+        const U64 newEnemyMask = enemyMask & ~(1ull << (Position(start).getRank()*8 + Position(end).getFile()));
         if (!isKingInCheck(kingPosition, newFriendMask, newEnemyMask, masks)) {
-            auto newBoard = result.emplace_back(make_unique<BitBoard>(*this));
-            newBoard->applyBishopMove(m);
-            newBoard->swapCurrentPlayer();
+            moveList.push({start, end, PackedMove::EnPassant});
         }
+        targets &= targets - 1;
     }
 }
 
-inline void BitBoard::applyAllKnightMoves(std::vector<std::shared_ptr<BitBoard>>& result, std::vector<Move>& moves, const int kingPosition, const U64 friendMask, const U64 enemyMask, std::shared_ptr<Masks> masks) const
+inline void BitBoard::addLegalKingMoves(MoveList& moveList, const int start, U64 targets, const int flags, const U64 friendMask, const U64 enemyMask, const Masks& masks) const
 {
-    for (auto& m : moves) {
-        const U64 newFriendMask = (friendMask & ~(1ull << m.start.position)) | (1ull << m.end.position);
-        const U64 newEnemyMask = enemyMask & ~(1ull << m.end.position);
-        if (!isKingInCheck(kingPosition, newFriendMask, newEnemyMask, masks)) {
-            auto newBoard = result.emplace_back(make_unique<BitBoard>(*this));
-            newBoard->applyKnightMove(m);
-            newBoard->swapCurrentPlayer();
+    const U64 kinglessFriendMask = (friendMask & ~(1ull << start));
+    while (targets > 0) {
+        const int end = std::countr_zero(targets);
+        const U64 newEnemyMask = enemyMask & ~(1ull << end);
+        // for this invokation of isKingInCheck(), unlike the one for other pieces, as the king has moved, I must use the move
+        // ending position, instead of the king's starting position
+        if (!isKingInCheck(end, kinglessFriendMask, newEnemyMask, masks)) {
+            moveList.push({start, end, flags});
         }
+        targets &= ~(1ull << end);
     }
 }
 
-inline void BitBoard::applyAllRookMoves(std::vector<std::shared_ptr<BitBoard>>& result, std::vector<Move>& moves, const int kingPosition, const U64 friendMask, const U64 enemyMask, std::shared_ptr<Masks> masks) const
+inline U64 BitBoard::getPieceTargets(const Piece piece, const int piecePosition, const int kingPosition, const U64 pinnedMask, const U64 occupiedMask, const Masks& masks) const
 {
-    for (auto& m : moves) {
-        const U64 newFriendMask = (friendMask & ~(1ull << m.start.position)) | (1ull << m.end.position);
-        const U64 newEnemyMask = enemyMask & ~(1ull << m.end.position);
-        if (!isKingInCheck(kingPosition, newFriendMask, newEnemyMask, masks)) {
-            auto newBoard = result.emplace_back(make_unique<BitBoard>(*this));
-            newBoard->applyRookMove(m);
-            newBoard->swapCurrentPlayer();
-        }
+    // these check for all valid moves, except for the fact that it ignores the illegality of ending in check.
+    // I call these, `candidate moves`.
+    U64 candidateMoves = 0ull;
+    if (piece == Piece::Q) {
+        candidateMoves = candidateQueenMoves(piecePosition, occupiedMask, masks);
+    } else if (piece == Piece::B) {
+        candidateMoves = candidateBishopMoves(piecePosition, occupiedMask, masks);
+    } else if (piece == Piece::N) {
+        candidateMoves = masks.knightAttackMasks[piecePosition];
+    } else if (piece == Piece::R) {
+        candidateMoves = candidateRookMoves(piecePosition, occupiedMask, masks);
+    }
+
+    // a pinned piece can only move along the line between its king and the piece pinning it
+    if (pinnedMask & (1ull << piecePosition)) {
+        candidateMoves &= masks.lineMask(kingPosition, piecePosition);
     }
+    return candidateMoves;
 }
 
-inline void BitBoard::applyAllQueenMoves(std::vector<std::shared_ptr<BitBoard>>& result, std::vector<Move>& moves, const int kingPosition, const U64 friendMask, const U64 enemyMask, std::shared_ptr<Masks> masks) const
+inline void BitBoard::addPieceMoves(MoveList& moveList, const Piece piece, const U64 targetMask, const int flags, const int kingPosition, const U64 pinnedMask, const U64 occupiedMask, const Masks& masks) const
 {
-    for (auto& m : moves) {
-        const U64 newFriendMask = (friendMask & ~(1ull << m.start.position)) | (1ull << m.end.position);
-        const U64 newEnemyMask = enemyMask & ~(1ull << m.end.position);
-        if (!isKingInCheck(kingPosition, newFriendMask, newEnemyMask, masks)) {
-            auto newBoard = result.emplace_back(make_unique<BitBoard>(*this));
-            newBoard->applyQueenMove(m);
-            newBoard->swapCurrentPlayer();
-        }
+    U64 ourPieces = pieces[getCurrentPlayerOffset() + piece];
+    while (ourPieces > 0) {
+        const int piecePosition = std::countr_zero(ourPieces);
+        addMoves(moveList, piecePosition, getPieceTargets(piece, piecePosition, kingPosition, pinnedMask, occupiedMask, masks) & targetMask, flags);
+        ourPieces &= ourPieces - 1;
     }
 }
 
-inline void BitBoard::applyAllKingMoves(std::vector<std::shared_ptr<BitBoard>>& result, std::vector<Move>& moves, const int kingPosition, const U64 friendMask, const U64 enemyMask, std::shared_ptr<Masks> masks) const
+inline void BitBoard::addPawnMoves(MoveList& moveList, const bool captures, const U64 pawns, const U64 allowedMask, const int kingPosition, const U64 friendMask, const U64 enemyMask, const Masks& masks) const
 {
-    for (auto& m : moves) {
-        const U64 kinglessFriendMask = (friendMask & ~(1ull << m.start.position));
-        const U64 newEnemyMask = enemyMask & ~(1ull << m.end.position);
-        // for this invokation of isKingInCheck(), unlike the one for other pieces, as the king has moved, I must use the move
-        // ending position, instead of the local variable `kingPosition`
-        if (!isKingInCheck(m.end.position, kinglessFriendMask, newEnemyMask, masks)) { 
-            auto newBoard = result.emplace_back(make_unique<BitBoard>(*this));
-            newBoard->applyKingMove(m);
-            newBoard->swapCurrentPlayer();
+    // every pawn is moved at once by shifting the whole mask, and the starting tile of each move is found again from its
+    // ending tile by undoing the shift (`delta`)
+    const bool isWhite = getCurrentPlayerOffset() == Player::White;
+    const U64 emptyMask = ~(friendMask | enemyMask);
+    if (!captures) {
+        const U64 singlePushes = pawnSinglePushes(pawns, emptyMask, isWhite);
+        const U64 doublePushes = pawnDoublePushes(singlePushes, emptyMask, isWhite, masks);
+        const int forward = isWhite ? 8 : -8;
+        addPawnTargets(moveList, singlePushes & allowedMask, forward, PackedMove::Quiet);
+        addPawnTargets(moveList, doublePushes & allowedMask, 2 * forward, PackedMove::DoublePawnPush);
+        return;
+    }
+
+    const U64 westCaptures = pawnWestCaptures(pawns, isWhite, masks);
+    const U64 eastCaptures = pawnEastCaptures(pawns, isWhite, masks);
+    const int westDelta = isWhite ? 7 : -9;
+    const int eastDelta = isWhite ? 9 : -7;
+    addPawnTargets(moveList, westCaptures & enemyMask & allowedMask, westDelta, PackedMove::Capture);
+    addPawnTargets(moveList, eastCaptures & enemyMask & allowedMask, eastDelta, PackedMove::Capture);
+
+    // an en passant capture moves diagonally onto an empty tile, and removes the enemy pawn beside us. That can uncover
+    // a check along our rank (which the pin mask does not cover, as two pieces leave it) or remove the piece giving check,
+    // so it ignores `allowedMask` and gets the full check test instead
+    const U64 enPassantMask = getEnPassantMask(isWhite);
+    if (enPassantMask) {
+        addEnPassantMoves(moveList, westCaptures & enPassantMask, westDelta, kingPosition, friendMask, enemyMask, masks);
+        addEnPassantMoves(moveList, eastCaptures & enPassantMask, eastDelta, kingPosition, friendMask, enemyMask, masks);
+    }
+}
+
+inline void BitBoard::addAllPawnMoves(MoveList& moveList, const bool captures, const int kingPosition, const U64 checkMask, const U64 pinnedMask, const U64 friendMask, const U64 enemyMask, const Masks& masks) const
+{
+    const U64 ourPawns = pieces[getCurrentPlayerOffset() + Piece::P];
+    addPawnMoves(moveList, captures, ourPawns & ~pinnedMask, checkMask, kingPosition, friendMask, enemyMask, masks);
+
+    // pinned pawns each have their own line to stay on, so they are done one at a time. There are rarely any.
+    U64 pinnedPawns = ourPawns & pinnedMask;
+    while (pinnedPawns > 0) {
+        const int pawnPosition = std::countr_zero(pinnedPawns);
+        addPawnMoves(moveList, captures, 1ull << pawnPosition, checkMask & masks.lineMask(kingPosition, pawnPosition), kingPosition, friendMask, enemyMask, masks);
+        pinnedPawns &= pinnedPawns - 1;
+    }
+}
+
+inline U64 BitBoard::getPinnedMask(const int kingPosition, const U64 friendMask, const U64 enemyMask, const Masks& masks) const
+{
+    const int otherPlayerOffset = getOtherPlayerOffset();
+    const U64 straightSliders = pieces[otherPlayerOffset + Piece::Q] | pieces[otherPlayerOffset + Piece::R];
+    const U64 diagonalSliders = pieces[otherPlayerOffset + Piece::Q] | pieces[otherPlayerOffset + Piece::B];
+
+    // cast rays from the king that only stop at enemy pieces. Any enemy slider they reach that has exactly one of our pieces
+    // (and nothing else) between it and the king is pinning that piece
+    U64 snipers = (masks.rookAttacks(kingPosition, enemyMask) & straightSliders) | (masks.bishopAttacks(kingPosition, enemyMask) & diagonalSliders);
+    U64 pinnedMask = 0ull;
+    while (snipers > 0) {
+        const U64 blockers = masks.betweenMask(kingPosition, std::countr_zero(snipers)) & (friendMask | enemyMask);
+        if (std::popcount(blockers) == 1) {
+            pinnedMask |= blockers & friendMask;
         }
+        snipers &= snipers - 1;
     }
+    return pinnedMask;
 }
-    
-std::vector<std::shared_ptr<BitBoard>> BitBoard::generateValidNextPositions() const
+
+void BitBoard::generateMoves(MoveList& moveList) const
 {
-    const int currentPlayerOffset = getCurrentPlayerOffset();
-    const auto masks = Masks::getMasks();
+    generateMoves(moveList, false);
+}
 
-    const Position kingPosition = std::countr_zero(pieces[currentPlayerOffset]);
-    const U64 enemyMask = getPlayerCombinedPieceMask(Player(getOtherPlayerOffset()));
-    const U64 friendMask = getPlayerCombinedPieceMask(Player(getCurrentPlayerOffset()));
+void BitBoard::generateCaptures(MoveList& moveList) const
+{
+    generateMoves(moveList, true);
+}
+
+bool BitBoard::isInCheck() const
+{
+    const Player player = Player(getCurrentPlayerOffset());
+    return isKingInCheck(std::countr_zero(pieces[player]), getPlayerCombinedPieceMask(player),
+                         getPlayerCombinedPieceMask(Player(getOtherPlayerOffset())), *Masks::getMasks());
+}
+
+inline void BitBoard::generateMoves(MoveList& moveList, const bool capturesOnly) const
+{
+    moveList.clear();
 
+    const auto& masksSingleton = Masks::getMasks();
+    const Masks& masks = *masksSingleton;
 
+    const int kingPosition = std::countr_zero(pieces[getCurrentPlayerOffset()]);
+    const U64 enemyMask = getPlayerCombinedPieceMask(Player(getOtherPlayerOffset()));
+    const U64 friendMask = getPlayerCombinedPieceMask(Player(getCurrentPlayerOffset()));
+    const U64 emptyMask = ~(friendMask | enemyMask);
 
     // check for checking pieces
-    std::vector<Position> enemyCheckingPieces;
+    U64 enemyCheckingPieces = 0ull;
     checkForKnightChecks(enemyCheckingPieces, kingPosition, enemyMask, masks);
     checkForHorizontalVerticalChecks(enemyCheckingPieces, kingPosition, friendMask, enemyMask, masks);
     checkForDiagonalChecks(enemyCheckingPieces, kingPosition, friendMask, enemyMask, masks);
     // don't need to check for enemy king checks because that would be impossible
 
-    std::vector<Move> kingMoves, queenMoves, bishopMoves, knightMoves, rookMoves, pawnMoves;
-    std::vector<Move> kingCaptureMoves, queenCaptureMoves, bishopCaptureMoves, knightCaptureMoves, rookCaptureMoves, pawnCaptureMoves;
+    // if our king is in double check, we must move it, and can't do anything else
+    const bool onlyKingMoves = std::popcount(enemyCheckingPieces) >= 2;
+    const U64 kingTargets = masks.kingAttackMasks[kingPosition];
+
+    // the moves of our other pieces are made legal by masking, rather than by testing each move for check:
+    // - in check, a move must capture the checking piece or block its ray (`checkMask`).
+    // - a pinned piece must stay on the line through the king and the piece pinning it (see `addPieceMoves`).
+    const U64 checkMask = enemyCheckingPieces ? (enemyCheckingPieces | masks.betweenMask(kingPosition, std::countr_zero(enemyCheckingPieces))) : ~0ull;
+    const U64 pinnedMask = getPinnedMask(kingPosition, friendMask, enemyMask, masks);
+    const U64 occupiedMask = friendMask | enemyMask;
+
+    // every way out of a check is needed, not just the captures, or a position in check would look like it has no moves
+    if (capturesOnly && !enemyCheckingPieces) {
+        addAllPawnMoves(moveList, true, kingPosition, checkMask, pinnedMask, friendMask, enemyMask, masks);
+        addPieceMoves(moveList, Piece::B, enemyMask, PackedMove::Capture, kingPosition, pinnedMask, occupiedMask, masks);
+        addPieceMoves(moveList, Piece::N, enemyMask, PackedMove::Capture, kingPosition, pinnedMask, occupiedMask, masks);
+        addPieceMoves(moveList, Piece::R, enemyMask, PackedMove::Capture, kingPosition, pinnedMask, occupiedMask, masks);
+        addPieceMoves(moveList, Piece::Q, enemyMask, PackedMove::Capture, kingPosition, pinnedMask, occupiedMask, masks);
+        addLegalKingMoves(moveList, kingPosition, kingTargets & enemyMask, PackedMove::Capture, friendMask, enemyMask, masks);
+        // pushes onto the last rank, which are promotions
+        const U64 lastRank = masks.rankMasks[(getCurrentPlayerOffset() == Player::White) ? A8 : A1];
+        addAllPawnMoves(moveList, false, kingPosition, lastRank, pinnedMask, friendMask, enemyMask, masks);
+        return;
+    }
+
+    // the order these are done in should be such that moves that are more likely to be better
+    // are put into `moveList` first.
 
-    // STEP 1: in any kind of position, we could try to move our king.
-    candidateKingMoves(kingMoves, kingCaptureMoves, kingPosition, friendMask, enemyMask, masks);
+    // get king non-capturing moves not involving castling
+    addLegalKingMoves(moveList, kingPosition, kingTargets & emptyMask, PackedMove::Quiet, friendMask, enemyMask, masks);
 
+    // check for castling
+    if (getCurrentPlayerOffset() == Player::White && !enemyCheckingPieces) {
+        if (isWhiteLeftCastleable() && checkCastleable(kingPosition, A1, friendMask, enemyMask, masks)) {
+            moveList.push({kingPosition, kingPosition-2, PackedMove::QueenSideCastle});
+        }
+        if (isWhiteRightCastleable() && checkCastleable(kingPosition, H1, friendMask, enemyMask, masks)) {
+            moveList.push({kingPosition, kingPosition+2, PackedMove::KingSideCastle});
+        }
+    } else if (getCurrentPlayerOffset() == Player::Black && !enemyCheckingPieces) {
+        if (isBlackLeftCastleable() && checkCastleable(kingPosition, A8, friendMask, enemyMask, masks)) {
+            moveList.push({kingPosition, kingPosition-2, PackedMove::QueenSideCastle});
+        } 
+        if (isBlackRightCastleable() && checkCastleable(kingPosition, H8, friendMask, enemyMask, masks)) {
+            moveList.push({kingPosition, kingPosition+2, PackedMove::KingSideCastle});
+        }
+    }
 
-    // STEP 2: if we are not in double check, we may do other things (if our king is in double check, we must move it, and can't do anything else)
-    if (enemyCheckingPieces.size() < 2) {
+    if (!onlyKingMoves) {
+        // get capturing moves that don't put the king in check
+        addAllPawnMoves(moveList, true, kingPosition, checkMask, pinnedMask, friendMask, enemyMask, masks);
+        addPieceMoves(moveList, Piece::B, enemyMask & checkMask, PackedMove::Capture, kingPosition, pinnedMask, occupiedMask, masks);
+        addPieceMoves(moveList, Piece::N, enemyMask & checkMask, PackedMove::Capture, kingPosition, pinnedMask, occupiedMask, masks);
+        addPieceMoves(moveList, Piece::R, enemyMask & checkMask, PackedMove::Capture, kingPosition, pinnedMask, occupiedMask, masks);
+        addPieceMoves(moveList, Piece::Q, enemyMask & checkMask, PackedMove::Capture, kingPosition, pinnedMask, occupiedMask, masks);
+    }
 
-        // find all moves candidate moves (a friendly pieces moves with or without capturing, without going through a friendly piece where applicable)
+    // get king capturing moves not involving castling
+    addLegalKingMoves(moveList, kingPosition, kingTargets & enemyMask, PackedMove::Capture, friendMask, enemyMask, masks);
 
-        U64 ourQueens = pieces[currentPlayerOffset + Piece::Q];      
-        U64 ourBishops = pieces[currentPlayerOffset + Piece::B];
-        U64 ourKnights = pieces[currentPlayerOffset + Piece::N];
-        U64 ourRook = pieces[currentPlayerOffset + Piece::R];
-        U64 ourPawns = pieces[currentPlayerOffset + Piece::P];
+    if (!onlyKingMoves) {
+        // get non-capturing moves that don't put the king in check
+        addPieceMoves(moveList, Piece::Q, emptyMask & checkMask, PackedMove::Quiet, kingPosition, pinnedMask, occupiedMask, masks);
+        addPieceMoves(moveList, Piece::R, emptyMask & checkMask, PackedMove::Quiet, kingPosition, pinnedMask, occupiedMask, masks);
+        addPieceMoves(moveList, Piece::B, emptyMask & checkMask, PackedMove::Quiet, kingPosition, pinnedMask, occupiedMask, masks);
+        addPieceMoves(moveList, Piece::N, emptyMask & checkMask, PackedMove::Quiet, kingPosition, pinnedMask, occupiedMask, masks);
+        addAllPawnMoves(moveList, false, kingPosition, checkMask, pinnedMask, friendMask, enemyMask, masks);
+    }
+}
 
-        // these check for all valid moves, except for the fact that it ignores the illegality of ending in check.
-        // I call these, `candidate moves`.
-        while (ourQueens > 0) {
-            const int piecePosition = std::countr_zero(ourQueens);
-            candidateQueenMoves(queenMoves, queenCaptureMoves, piecePosition, friendMask, enemyMask, masks);
-            ourQueens &= ~(1ull << piecePosition);
+inline int BitBoard::countLegalKingMoves(const int start, U64 targets, const U64 friendMask, const U64 enemyMask, const Masks& masks) const
+{
+    // each king move still needs its own check test, like in `addLegalKingMoves`
+    const U64 kinglessFriendMask = (friendMask & ~(1ull << start));
+    int count = 0;
+    while (targets > 0) {
+        const int end = std::countr_zero(targets);
+        if (!isKingInCheck(end, kinglessFriendMask, enemyMask & ~(1ull << end), masks)) {
+            ++count;
         }
+        targets &= targets - 1;
+    }
+    return count;
+}
 
-        while (ourBishops > 0) {
-            const int piecePosition = std::countr_zero(ourBishops);
-            candidateBishopMoves(bishopMoves, bishopCaptureMoves, piecePosition, friendMask, enemyMask, masks);
-            ourBishops &= ~(1ull << piecePosition);
-        }
+inline int BitBoard::countPieceMoves(const Piece piece, const U64 targetMask, const int kingPosition, const U64 pinnedMask, const U64 occupiedMask, const Masks& masks) const
+{
+    U64 ourPieces = pieces[getCurrentPlayerOffset() + piece];
+    int count = 0;
+    while (ourPieces > 0) {
+        count += std::popcount(getPieceTargets(piece, std::countr_zero(ourPieces), kingPosition, pinnedMask, occupiedMask, masks) & targetMask);
+        ourPieces &= ourPieces - 1;
+    }
+    return count;
+}
+
+inline int BitBoard::countPawnMoves(const U64 pawns, const U64 allowedMask, const int kingPosition, const U64 friendMask, const U64 enemyMask, const Masks& masks) const
+{
+    const bool isWhite = getCurrentPlayerOffset() == Player::White;
+    const U64 emptyMask = ~(friendMask | enemyMask);
+    const U64 singlePushes = pawnSinglePushes(pawns, emptyMask, isWhite);
+    const U64 doublePushes = pawnDoublePushes(singlePushes, emptyMask, isWhite, masks);
+    const U64 westCaptures = pawnWestCaptures(pawns, isWhite, masks);
+    const U64 eastCaptures = pawnEastCaptures(pawns, isWhite, masks);
+
+    // a pawn reaching the last rank makes four moves, one for each promotion
+    const U64 lastRank = masks.rankMasks[isWhite ? A8 : A1];
+    int count = std::popcount(doublePushes & allowedMask);
+    for (const U64 targets : {singlePushes & allowedMask, westCaptures & enemyMask & allowedMask, eastCaptures & enemyMask & allowedMask}) {
+        count += std::popcount(targets) + 3 * std::popcount(targets & lastRank);
+    }
+
+    // en passant captures are rare and need the full check test, so they are simply generated
+    const U64 enPassantMask = getEnPassantMask(isWhite);
+    if (enPassantMask) {
+        MoveList enPassantMoves;
+        addEnPassantMoves(enPassantMoves, westCaptures & enPassantMask, isWhite ? 7 : -9, kingPosition, friendMask, enemyMask, masks);
+        addEnPassantMoves(enPassantMoves, eastCaptures & enPassantMask, isWhite ? 9 : -7, kingPosition, friendMask, enemyMask, masks);
+        count += enPassantMoves.size();
+    }
+    return count;
+}
+
+inline int BitBoard::countLegalMoves(const bool stopAtFirst) const
+{
+    const auto& masksSingleton = Masks::getMasks();
+    const Masks& masks = *masksSingleton;
+
+    const int kingPosition = std::countr_zero(pieces[getCurrentPlayerOffset()]);
+    const U64 enemyMask = getPlayerCombinedPieceMask(Player(getOtherPlayerOffset()));
+    const U64 friendMask = getPlayerCombinedPieceMask(Player(getCurrentPlayerOffset()));
+    const U64 occupiedMask = friendMask | enemyMask;
 
-        while (ourKnights > 0) {
-            const int piecePosition = std::countr_zero(ourKnights);
-            candidateKnightMoves(knightMoves, knightCaptureMoves, piecePosition, friendMask, enemyMask, masks);
-            ourKnights &= ~(1ull << piecePosition);
-        }            
+    // the king is tried first, since it usually has a move and is the only piece that can move in double check
+    int count = countLegalKingMoves(kingPosition, masks.kingAttackMasks[kingPosition] & ~friendMask, friendMask, enemyMask, masks);
+    if (stopAtFirst && count > 0) {
+        return count;
+    }
 
-        while (ourRook > 0) {
-            const int piecePosition = std::countr_zero(ourRook);
-            candidateRookMoves(rookMoves, rookCaptureMoves, piecePosition, friendMask, enemyMask, masks);
-            ourRook &= ~(1ull << piecePosition);
+    U64 enemyCheckingPieces = 0ull;
+    checkForKnightChecks(enemyCheckingPieces, kingPosition, enemyMask, masks);
+    checkForHorizontalVerticalChecks(enemyCheckingPieces, kingPosition, friendMask, enemyMask, masks);
+    checkForDiagonalChecks(enemyCheckingPieces, kingPosition, friendMask, enemyMask, masks);
+    if (std::popcount(enemyCheckingPieces) >= 2) {
+        return count;
+    }
+
+    // castling can only be legal when the king can also step onto the tile beside it, so it never decides whether there
+    // are any moves, and is only needed for the full count
+    if (!stopAtFirst && !enemyCheckingPieces) {
+        if (getCurrentPlayerOffset() == Player::White) {
+            count += isWhiteLeftCastleable() && checkCastleable(kingPosition, A1, friendMask, enemyMask, masks);
+            count += isWhiteRightCastleable() && checkCastleable(kingPosition, H1, friendMask, enemyMask, masks);
+        } else {
+            count += isBlackLeftCastleable() && checkCastleable(kingPosition, A8, friendMask, enemyMask, masks);
+            count += isBlackRightCastleable() && checkCastleable(kingPosition, H8, friendMask, enemyMask, masks);
         }
-        
-        while (ourPawns > 0) {
-            const int piecePosition = std::countr_zero(ourPawns);
-
-            // finding pawn moves is different based on their logic
-            if (currentPlayerOffset == Player::White) {
-                candidateWhitePawnMoves(pawnMoves, pawnCaptureMoves, piecePosition, friendMask, enemyMask, masks);
-            } else {
-                candidateBlackPawnMoves(pawnMoves, pawnCaptureMoves, piecePosition, friendMask, enemyMask, masks);
-            }
+    }
 
-            ourPawns &= ~(1ull << piecePosition);
+    // the same masks as `generateMoves` make the moves of the other pieces legal
+    const U64 checkMask = enemyCheckingPieces ? (enemyCheckingPieces | masks.betweenMask(kingPosition, std::countr_zero(enemyCheckingPieces))) : ~0ull;
+    const U64 pinnedMask = getPinnedMask(kingPosition, friendMask, enemyMask, masks);
+    const U64 targetMask = ~friendMask & checkMask;
+    for (const Piece piece : {Piece::N, Piece::B, Piece::R, Piece::Q}) {
+        count += countPieceMoves(piece, targetMask, kingPosition, pinnedMask, occupiedMask, masks);
+        if (stopAtFirst && count > 0) {
+            return count;
         }
     }
 
-    // STEP 3: construct boards for all moves which don't end with the king in check.
-    // the order these are done in should be such that boards that are more likely to be better
-    // are put into `result` first.
-    vector<std::shared_ptr<BitBoard>> result;
+    const U64 ourPawns = pieces[getCurrentPlayerOffset() + Piece::P];
+    count += countPawnMoves(ourPawns & ~pinnedMask, checkMask, kingPosition, friendMask, enemyMask, masks);
+    U64 pinnedPawns = ourPawns & pinnedMask;
+    while (pinnedPawns > 0) {
+        const int pawnPosition = std::countr_zero(pinnedPawns);
+        count += countPawnMoves(1ull << pawnPosition, checkMask & masks.lineMask(kingPosition, pawnPosition), kingPosition, friendMask, enemyMask, masks);
+        pinnedPawns &= pinnedPawns - 1;
+    }
+    return count;
+}
 
-    // get king non-capturing moves not involving castling
-    applyAllKingMoves(result, kingMoves, kingPosition.position, friendMask, enemyMask, masks);
+bool BitBoard::hasAnyLegalMove() const
+{
+    return countLegalMoves(true) > 0;
+}
 
-    // check for castling
-    if (getCurrentPlayerOffset() == Player::White && enemyCheckingPieces.empty()) {
-        if (isWhiteLeftCastleable() && checkCastleable(kingPosition.position, A1, friendMask, enemyMask, masks)) {
-            auto newBoard = result.emplace_back(make_unique<BitBoard>(*this));
-            newBoard->applyKingMove({kingPosition, kingPosition.position-2}); 
-            newBoard->applyRookMove({A1, kingPosition.position-1}); 
-            newBoard->swapCurrentPlayer();
+int BitBoard::countLegalMoves() const
+{
+    return countLegalMoves(false);
+}
+
+inline U64 BitBoard::getAttackersTo(const int position, const U64 occupiedMask, const Masks& masks) const
+{
+    const U64 straightSliders = pieces[Piece::Q] | pieces[Piece::R] | pieces[Piece::q] | pieces[Piece::r];
+    const U64 diagonalSliders = pieces[Piece::Q] | pieces[Piece::B] | pieces[Piece::q] | pieces[Piece::b];
+    // a pawn attacks `position` exactly when an enemy pawn on `position` would attack it
+    const U64 positionMask = 1ull << position;
+    const U64 whitePawnAttackers = pawnWestCaptures(positionMask, false, masks) | pawnEastCaptures(positionMask, false, masks);
+    const U64 blackPawnAttackers = pawnWestCaptures(positionMask, true, masks) | pawnEastCaptures(positionMask, true, masks);
+
+    return (masks.knightAttackMasks[position] & (pieces[Piece::N] | pieces[Piece::n]))
+        | (masks.kingAttackMasks[position] & (pieces[Piece::K] | pieces[Piece::k]))
+        | (masks.rookAttacks(position, occupiedMask) & straightSliders)
+        | (masks.bishopAttacks(position, occupiedMask) & diagonalSliders)
+        | (whitePawnAttackers & pieces[Piece::P])
+        | (blackPawnAttackers & pieces[Piece::p]);
+}
+
+int BitBoard::see(const PackedMove move) const
+{
+    const auto& masksSingleton = Masks::getMasks();
+    const Masks& masks = *masksSingleton;
+
+    const int start = move.getStart();
+    const int end = move.getEnd();
+    const U64 straightSliders = pieces[Piece::Q] | pieces[Piece::R] | pieces[Piece::q] | pieces[Piece::r];
+    const U64 diagonalSliders = pieces[Piece::Q] | pieces[Piece::B] | pieces[Piece::q] | pieces[Piece::b];
+    U64 occupiedMask = getPlayerCombinedPieceMask(Player::White) | getPlayerCombinedPieceMask(Player::Black);
+
+    // `gains[i]` is what the player making the ith capture has won so far, if the exchange stopped right after it
+    int gains[32];
+    int depth = 0;
+    gains[0] = 0;
+    if (move.isEnPassant()) {
+        gains[0] = seeValues[Piece::P];
+        occupiedMask ^= 1ull << (end + ((getCurrentPlayerOffset() == Player::White) ? -8 : 8));
+    } else if (move.isCapture()) {
+        gains[0] = seeValues[getPiece(end) % 6];
+    }
+    // the piece now standing on `end`, which is the next to be captured
+    int targetValue = seeValues[getPiece(start) % 6];
+    if (move.isPromotion()) {
+        gains[0] += seeValues[move.getPromotion()] - seeValues[Piece::P];
+        targetValue = seeValues[move.getPromotion()];
+    }
+
+    U64 attackerMask = 1ull << start;
+    U64 attackers = getAttackersTo(end, occupiedMask, masks);
+    int sideOffset = getCurrentPlayerOffset();
+    while (true) {
+        // take the last attacker off the board, which can uncover a slider behind it
+        occupiedMask ^= attackerMask;
+        attackers |= (masks.rookAttacks(end, occupiedMask) & straightSliders) | (masks.bishopAttacks(end, occupiedMask) & diagonalSliders);
+        attackers &= occupiedMask;
+
+        // the other side recaptures with its least valuable attacker, if it has one
+        sideOffset = (sideOffset == Player::White) ? Player::Black : Player::White;
+        const U64 sideAttackers = attackers & getPlayerCombinedPieceMask(Player(sideOffset));
+        if (!sideAttackers) {
+            break;
         }
-        if (isWhiteRightCastleable() && checkCastleable(kingPosition.position, H1, friendMask, enemyMask, masks)) {
-            auto newBoard = result.emplace_back(make_unique<BitBoard>(*this));
-            newBoard->applyKingMove({kingPosition, kingPosition.position+2}); 
-            newBoard->applyRookMove({H1, kingPosition.position+1}); 
-            newBoard->swapCurrentPlayer();
+        int attacker = Piece::P;
+        for (const int piece : {Piece::P, Piece::N, Piece::B, Piece::R, Piece::Q, Piece::K}) {
+            if (sideAttackers & pieces[sideOffset + piece]) {
+                attacker = piece;
+                break;
+            }
         }
-    } else if (getCurrentPlayerOffset() == Player::Black && enemyCheckingPieces.empty()) {
-        if (isBlackLeftCastleable() && checkCastleable(kingPosition.position, A8, friendMask, enemyMask, masks)) {
-            auto newBoard = result.emplace_back(make_unique<BitBoard>(*this));
-            newBoard->applyKingMove({kingPosition, kingPosition.position-2}); 
-            newBoard->applyRookMove({A8, kingPosition.position-1});
-            newBoard->swapCurrentPlayer();
-        } 
-        if (isBlackRightCastleable() && checkCastleable(kingPosition.position, H8, friendMask, enemyMask, masks)) {
-            auto newBoard = result.emplace_back(make_unique<BitBoard>(*this));
-            newBoard->applyKingMove({kingPosition, kingPosition.position+2}); 
-            newBoard->applyRookMove({H8, kingPosition.position+1}); 
-            newBoard->swapCurrentPlayer();
+        ++depth;
+        gains[depth] = targetValue - gains[depth - 1];
+        if (depth == 31) {
+            break;
         }
+        targetValue = seeValues[attacker];
+        attackerMask = sideAttackers & pieces[sideOffset + attacker];
+        attackerMask &= -attackerMask;
     }
 
-    // get pawn capturing moves that don't put the king in check
-    applyAllPawnMoves(result, pawnCaptureMoves, kingPosition.position, friendMask, enemyMask, masks);
+    // each side only makes its capture if that is better than stopping the exchange before it
+    while (depth > 0) {
+        gains[depth - 1] = -std::max(-gains[depth - 1], gains[depth]);
+        --depth;
+    }
+    return gains[0];
+}
 
-    // get bishop capturing moves that don't put the king in check
-    applyAllBishopMoves(result, bishopCaptureMoves, kingPosition.position, friendMask, enemyMask, masks);
+void BitBoard::applyMove(const PackedMove move)
+{
+    const Move m = {move.getStart(), move.getEnd()};
+    const int currentPlayerOffset = getCurrentPlayerOffset();
+    const int otherPlayerOffset = getOtherPlayerOffset();
+    const int pieceOffset = findPieceOffset(m.start, currentPlayerOffset);
 
-    // get knight capturing moves that don't put the king in check
-    applyAllKnightMoves(result, knightCaptureMoves, kingPosition.position, friendMask, enemyMask, masks);
+    // the move's flags say if it captures, so we only look for the captured piece when there is one.
+    // an en passant capture takes the pawn beside the starting tile rather than the one on the ending tile
+    if (move.isEnPassant()) {
+        capturePiece(otherPlayerOffset + Piece::P, m.start.getRank()*8 + m.end.getFile());
+    } else if (move.isCapture()) {
+        capturePiece(otherPlayerOffset + findPieceOffset(m.end, otherPlayerOffset), m.end.position);
+    }
 
-    // get rook capturing moves that don't put the king in check
-    applyAllRookMoves(result, rookCaptureMoves, kingPosition.position, friendMask, enemyMask, masks);
+    // pawn moves and captures reset the halfmove clock, and the fullmove number goes up after Black moves
+    if (pieceOffset == Piece::P || move.isCapture()) {
+        halfmoveClock = 0;
+    } else {
+        ++halfmoveClock;
+    }
+    if (currentPlayerOffset == Player::Black) {
+        ++fullmoveNumber;
+    }
 
-    // get queen capturing moves that don't put the king in check
-    applyAllQueenMoves(result, queenCaptureMoves, kingPosition.position, friendMask, enemyMask, masks);
+    if (pieceOffset == Piece::K) {
+        applyKingMove(m);
 
-    // get king capturing moves not involving castling
-    applyAllKingMoves(result, kingCaptureMoves, kingPosition.position, friendMask, enemyMask, masks);
+        // when castling, the rook jumps over to the tile the king passed through
+        if (move.getFlags() == PackedMove::KingSideCastle) {
+            applyRookMove({m.start.position + 3, m.start.position + 1});
+        } else if (move.getFlags() == PackedMove::QueenSideCastle) {
+            applyRookMove({m.start.position - 4, m.start.position - 1});
+        }
+    } else if (pieceOffset == Piece::Q) {
+        applyQueenMove(m);
+    } else if (pieceOffset == Piece::B) {
+        applyBishopMove(m);
+    } else if (pieceOffset == Piece::N) {
+        applyKnightMove(m);
+    } else if (pieceOffset == Piece::R) {
+        applyRookMove(m);
+    } else if (pieceOffset == Piece::P) {
+        applyPawnMove(m);
+        if (move.getPromotion()) {
+            capturePiece(currentPlayerOffset + Piece::P, m.end.position);
+            placePiece(currentPlayerOffset + move.getPromotion(), m.end.position);
+        }
+    }
+
+    // a rook that is captured on its starting tile can no longer castle
+    if (m.end.position == A1) {
+        setWhiteLeftRookMoved();
+    } else if (m.end.position == H1) {
+        setWhiteRightRookMoved();
+    } else if (m.end.position == A8) {
+        setBlackLeftRookMoved();
+    } else if (m.end.position == H8) {
+        setBlackRightRookMoved();
+    }
+
+    swapCurrentPlayer();
+}
+
+Undo BitBoard::makeMove(const PackedMove move)
+{
+    const int start = move.getStart();
+    const int end = move.getEnd();
+    const int otherPlayerOffset = getOtherPlayerOffset();
+    Undo undo{Piece::DarkNone, end, temporalInfo, hashKey, pawnKey, halfmoveClock};
+
+    // an en passant capture takes the pawn beside the starting tile
+    if (move.isEnPassant()) {
+        undo.capturedPiece = Piece(otherPlayerOffset + Piece::P);
+        undo.capturedPosition = Position(start).getRank()*8 + Position(end).getFile();
+    } else if (move.isCapture()) {
+        undo.capturedPiece = Piece(otherPlayerOffset + findPieceOffset(end, otherPlayerOffset));
+    }
+
+    applyMove(move);
+    return undo;
+}
+
+void BitBoard::unmakeMove(const PackedMove move, const Undo& undo)
+{
+    const int start = move.getStart();
+    const int end = move.getEnd();
+
+    // this also gives the turn back to the player who made the move.
+    // the hash keys are restored directly, so the pieces below are put back without updating it.
+    temporalInfo = undo.temporalInfo;
+    hashKey = undo.hashKey;
+    pawnKey = undo.pawnKey;
+    halfmoveClock = undo.halfmoveClock;
+    const int currentPlayerOffset = getCurrentPlayerOffset();
+    if (currentPlayerOffset == Player::Black) {
+        --fullmoveNumber;
+    }
 
-    // get queen moves that don't put the king in check
-    applyAllQueenMoves(result, queenMoves, kingPosition.position, friendMask, enemyMask, masks);
+    if (move.getPromotion()) {
+        pieces[currentPlayerOffset + move.getPromotion()] &= ~(1ull << end);
+        pieces[currentPlayerOffset + Piece::P] |= (1ull << start);
+        updatePieceScores(currentPlayerOffset + move.getPromotion(), end, -1);
+        updatePieceScores(currentPlayerOffset + Piece::P, start, 1);
+    } else {
+        const int pieceOffset = findPieceOffset(end, currentPlayerOffset);
+        pieces[currentPlayerOffset + pieceOffset] ^= (1ull << start) | (1ull << end);
+        updatePieceScores(currentPlayerOffset + pieceOffset, end, -1);
+        updatePieceScores(currentPlayerOffset + pieceOffset, start, 1);
+
+        // take back the rook's part of a castling move
+        if (move.getFlags() == PackedMove::KingSideCastle) {
+            pieces[currentPlayerOffset + Piece::R] ^= (1ull << (start + 3)) | (1ull << (start + 1));
+            updatePieceScores(currentPlayerOffset + Piece::R, start + 1, -1);
+            updatePieceScores(currentPlayerOffset + Piece::R, start + 3, 1);
+        } else if (move.getFlags() == PackedMove::QueenSideCastle) {
+            pieces[currentPlayerOffset + Piece::R] ^= (1ull << (start - 4)) | (1ull << (start - 1));
+            updatePieceScores(currentPlayerOffset + Piece::R, start - 1, -1);
+            updatePieceScores(currentPlayerOffset + Piece::R, start - 4, 1);
+        }
+    }
 
-    // get rook moves that don't put the king in check
-    applyAllRookMoves(result, rookMoves, kingPosition.position, friendMask, enemyMask, masks);
+    if (undo.capturedPiece != Piece::DarkNone) {
+        pieces[undo.capturedPiece] |= (1ull << undo.capturedPosition);
+        updatePieceScores(undo.capturedPiece, undo.capturedPosition, 1);
+    }
+}
 
-    // get bishop moves that don't put the king in check
-    applyAllBishopMoves(result, bishopMoves, kingPosition.position, friendMask, enemyMask, masks);
+Undo BitBoard::makeNullMove()
+{
+    Undo undo{Piece::DarkNone, 0, temporalInfo, hashKey, pawnKey, halfmoveClock};
+    // en passant is only possible right after the double push, which is now a move ago
+    resetEnpassantFlags();
+    ++halfmoveClock;
+    swapCurrentPlayer();
+    return undo;
+}
 
-    // get knight moves that don't put the king in check
-    applyAllKnightMoves(result, knightMoves, kingPosition.position, friendMask, enemyMask, masks);
+void BitBoard::unmakeNullMove(const Undo& undo)
+{
+    temporalInfo = undo.temporalInfo;
+    hashKey = undo.hashKey;
+    halfmoveClock = undo.halfmoveClock;
+}
 
-    // get pawn moves that don't put the king in check
-    applyAllPawnMoves(result, pawnMoves, kingPosition.position, friendMask, enemyMask, masks);
+bool BitBoard::hasNonPawnMaterial(const Player player) const
+{
+    const int playerOffset = player;
+    return pieces[playerOffset + Piece::Q] | pieces[playerOffset + Piece::B] | pieces[playerOffset + Piece::N] | pieces[playerOffset + Piece::R];
+}
 
+bool BitBoard::isPawnless() const
+{
+    return !(pieces[Piece::P] | pieces[Piece::p]);
+}
+
+std::vector<std::shared_ptr<BitBoard>> BitBoard::generateValidNextPositions() const
+{
+    MoveList moves;
+    generateMoves(moves);
+
+    std::vector<std::shared_ptr<BitBoard>> result;
+    result.reserve(moves.size());
+    for (const auto move : moves) {
+        auto newBoard = result.emplace_back(make_shared<BitBoard>(*this));
+        newBoard->applyMove(move);
+    }
 
 #ifdef DEBUG
     for (auto& m : result) {
@@ -862,70 +1189,61 @@ std::vector<std::shared_ptr<BitBoard>> BitBoard::generateValidNextPositions() co
 #endif
 
     return result;
-
 }
 
-BitBoard::BitBoard(const BitBoard& bitboard) : temporalInfo{bitboard.temporalInfo}
+BitBoard::BitBoard(const BitBoard& bitboard) : temporalInfo{bitboard.temporalInfo}, hashKey{bitboard.hashKey}, pawnKey{bitboard.pawnKey},
+    pieceScores{bitboard.pieceScores}, halfmoveClock{bitboard.halfmoveClock}, fullmoveNumber{bitboard.fullmoveNumber}
 {
     std::copy(bitboard.pieces, bitboard.pieces + 12, this->pieces);
 }
 
+// a BitBoard holds no resources, so moving it is the same as copying it
+BitBoard::BitBoard(BitBoard&& bitboard) : BitBoard{static_cast<const BitBoard&>(bitboard)} {}
+
 BoardStateSimplified BitBoard::getStateSimplified() const
 {
-    const U64 whiteMask = getPlayerCombinedPieceMask(Player::White);
-    const U64 blackMask = getPlayerCombinedPieceMask(Player::Black);
-
-    bool whiteInCheck = false;
-    bool blackInCheck = false;
-    if (getCurrentPlayerOffset() == Player::White) {
-        whiteInCheck = isKingInCheck(std::countr_zero(pieces[Piece::K]), whiteMask, blackMask, Masks::getMasks());
-    } else {
-        blackInCheck = isKingInCheck(std::countr_zero(pieces[Piece::k]), blackMask, whiteMask, Masks::getMasks());
-    }
-
-    const int legalMoveCount = generateValidNextPositions().size();
-
     bool whiteHasWin = false;
     bool blackHasWin = false;
     bool hasDraw = false;
 
-    if (getCurrentPlayerOffset() == Player::Black && legalMoveCount == 0) {
-        // checkmate
-        if (blackInCheck) {
-            whiteHasWin = true;
-        // stalemate
-        } else {
+    // with no legal moves, it is checkmate if the current player is in check, and stalemate otherwise
+    if (!hasAnyLegalMove()) {
+        if (!isInCheck()) {
             hasDraw = true;
-        }
-    } else if (getCurrentPlayerOffset() == Player::White && legalMoveCount == 0) {
-        // checkmate
-        if (whiteInCheck) {
+        } else if (getCurrentPlayerOffset() == Player::White) {
             blackHasWin = true;
-        // stalemate
         } else {
-            hasDraw = true;
+            whiteHasWin = true;
         }
     }
 
-    // check for draws from insufficient material (not physically possible to checkmate):
-
-    // king vs king
-    if (std::popcount(whiteMask) == 1 && std::popcount(blackMask) == 1) {
+    if (hasInsufficientMaterial()) {
         hasDraw = true;
+    }
 
-    // king and (one of {knight, bishop}) vs king
-    } else if ((std::popcount(whiteMask) + std::popcount(blackMask) == 3) 
-                && (std::popcount(pieces[Piece::B]) + std::popcount(pieces[Piece::N]) 
-                + std::popcount(pieces[Piece::b]) + std::popcount(pieces[Piece::n]) == 1)) {
-        hasDraw = true;
+    return BoardStateSimplified(whiteHasWin, hasDraw, blackHasWin);
+}
 
-    // king and bishop vs king and bishop, but both bishops are the same colour
-    } else if (std::popcount(whiteMask) + std::popcount(blackMask) == 4 && std::popcount(pieces[Piece::B]) == 1 && std::popcount(pieces[Piece::b]) == 1
-    && std::countr_zero(pieces[Piece::B]) % 2 == std::countr_zero(pieces[Piece::b]) % 2) {
-        hasDraw = true;
+bool BitBoard::hasInsufficientMaterial() const
+{
+    // any pawn, rook or queen is always enough
+    if (pieces[Piece::P] | pieces[Piece::p] | pieces[Piece::R] | pieces[Piece::r] | pieces[Piece::Q] | pieces[Piece::q]) {
+        return false;
     }
 
-    return BoardStateSimplified(whiteHasWin, hasDraw, blackHasWin);
+    const U64 whiteMinors = pieces[Piece::B] | pieces[Piece::N];
+    const U64 blackMinors = pieces[Piece::b] | pieces[Piece::n];
+    const int minorCount = std::popcount(whiteMinors) + std::popcount(blackMinors);
+
+    // king vs king, or king and (one of {knight, bishop}) vs king
+    if (minorCount <= 1) {
+        return true;
+    }
+
+    // king and bishop vs king and bishop, but both bishops are on the same colour of tile
+    static const U64 lightTiles = 0x55AA55AA55AA55AAull;
+    return minorCount == 2 && std::popcount(pieces[Piece::B]) == 1 && std::popcount(pieces[Piece::b]) == 1
+        && !(pieces[Piece::B] & lightTiles) == !(pieces[Piece::b] & lightTiles);
 }
 
 BoardState BitBoard::getState() const
@@ -939,9 +1257,9 @@ BoardState BitBoard::getState() const
     bool whiteInCheck = false;
     bool blackInCheck = false;
     if (getCurrentPlayerOffset() == Player::White) {
-        whiteInCheck = isKingInCheck(std::countr_zero(pieces[Piece::K]), whiteMask, blackMask, Masks::getMasks());
+        whiteInCheck = isKingInCheck(std::countr_zero(pieces[Piece::K]), whiteMask, blackMask, *Masks::getMasks());
     } else {
-        blackInCheck = isKingInCheck(std::countr_zero(pieces[Piece::k]), blackMask, whiteMask, Masks::getMasks());
+        blackInCheck = isKingInCheck(std::countr_zero(pieces[Piece::k]), blackMask, whiteMask, *Masks::getMasks());
     }
 
     return BoardState(grid, Player(getCurrentPlayerOffset()), simpleState.whiteHasWin, simpleState.hasDraw, simpleState.blackHasWin, whiteInCheck, blackInCheck);
@@ -953,58 +1271,47 @@ BoardState BitBoard::getStateSetup() const
     return BoardState(grid, Player::White, false, false, false, false, false);
 }
 
-bool BitBoard::isValidMove(const Move& move) const
+std::optional<PackedMove> BitBoard::findLegalMove(const Move& move, const Piece promotion) const
 {
-    std::vector<std::shared_ptr<BitBoard>> possibleNextBoards = generateValidNextPositions();
-    BitBoard copy = BitBoard{*this};
-    copy.makePlayerMove(move);
-    for (auto board : possibleNextBoards) {
-        if (copy == *board) {
-            return true;
+    // a promotion must be into one of the current player's own pieces
+    int promotionOffset = 0;
+    if (promotion != Piece::DarkNone) {
+        promotionOffset = promotion - getCurrentPlayerOffset();
+        if (promotionOffset < Piece::Q || promotionOffset > Piece::R) {
+            return std::nullopt;
         }
     }
-    return false;
+
+    // a move given by its tiles is the same as a legal move if their tiles (ignoring the flags) and promotion match
+    MoveList moves;
+    generateMoves(moves);
+    const uint16_t squares = PackedMove{move.start.position, move.end.position}.getSquares();
+    for (const auto legalMove : moves) {
+        if (legalMove.getSquares() == squares && legalMove.getPromotion() == promotionOffset) {
+            return legalMove;
+        }
+    }
+    return std::nullopt;
+}
+
+bool BitBoard::isValidMove(const Move& move) const
+{
+    return findLegalMove(move).has_value();
+}
+
+bool BitBoard::isValidPromotionMove(const Move& move, const Piece piece) const
+{
+    return findLegalMove(move, piece).has_value();
 }
 
 void BitBoard::makePlayerMove(const Move& move)
 {
-    const int currentPlayersTurn = getCurrentPlayerOffset();
-    const int pieceOffset = findPieceOffset(move.start.position, currentPlayersTurn);
-    if (pieceOffset == Piece::K) {
-        // white left castle
-        if (move.start.position == E1 && move.end.position == C1) {
-            applyKingMove({E1, C1}); 
-            applyRookMove({A1, D1}); 
-        // white right castle
-        } else if (move.start.position == E1 && move.end.position == G1) {
-            applyKingMove({E1, G1}); 
-            applyRookMove({H1, F1}); 
-        // black left castle
-        } else if (move.start.position == E8 && move.end.position == C8) {
-            applyKingMove({E8, C8}); 
-            applyRookMove({A8, D8}); 
-        // black right castle
-        } else if (move.start.position == E8 && move.end.position == G8) {
-            applyKingMove({E8, G8}); 
-            applyRookMove({H8, F8}); 
-
-        // normal king move
-        } else {
-            applyKingMove(move);
-        }
-    } else if (pieceOffset == Piece::Q) {
-        applyQueenMove(move);
-    } else if (pieceOffset == Piece::B) {
-        applyBishopMove(move);
-    } else if (pieceOffset == Piece::N) {
-        applyKnightMove(move);
-    } else if (pieceOffset == Piece::R) {
-        applyRookMove(move);
-    } else if (pieceOffset == Piece::P) {
-        applyPawnMove(move);
-    }
-    
-    swapCurrentPlayer();
+    applyMove(*findLegalMove(move));
+}
+
+void BitBoard::makePlayerPromotionMove(const Move& move, const Piece piece)
+{
+    applyMove(*findLegalMove(move, piece));
 }
 
 Piece BitBoard::getPiece(const Position& position) const
@@ -1025,16 +1332,74 @@ Piece BitBoard::getPiece(const Position& position) const
 
 void BitBoard::setPiece(const Position& position, const Piece& piece)
 {
-    pieces[piece] |= (1ull << position.position);
+    placePiece(piece, position.position);
 }
 
 void BitBoard::removePiece(const Position& position)
 {
     for (int piece = 0; piece < 12; ++piece) {
-        pieces[piece] &= ~(1ull << position.position);
+        if (pieces[piece] & (1ull << position.position)) {
+            capturePiece(piece, position.position);
+        }
     }
 }
 
+U64 BitBoard::getHashKey() const
+{
+    return hashKey;
+}
+
+U64 BitBoard::getPawnKey() const
+{
+    return pawnKey;
+}
+
+U64 BitBoard::computeHashKey() const
+{
+    U64 key = 0ull;
+    for (int piece = 0; piece < 12; ++piece) {
+        U64 pieceMask = pieces[piece];
+        while (pieceMask > 0) {
+            key ^= zobrist.pieceKeys[piece][std::countr_zero(pieceMask)];
+            pieceMask &= pieceMask - 1;
+        }
+    }
+    uint32_t temporalBits = temporalInfo;
+    while (temporalBits > 0) {
+        key ^= zobrist.temporalKeys[std::countr_zero(temporalBits)];
+        temporalBits &= temporalBits - 1;
+    }
+    return key;
+}
+
+U64 BitBoard::computePawnKey() const
+{
+    U64 key = 0ull;
+    for (const int piece : {Piece::P, Piece::p}) {
+        U64 pawnMask = pieces[piece];
+        while (pawnMask > 0) {
+            key ^= zobrist.pieceKeys[piece][std::countr_zero(pawnMask)];
+            pawnMask &= pawnMask - 1;
+        }
+    }
+    return key;
+}
+
+BitBoard::PieceScores BitBoard::computePieceScores() const
+{
+    PieceScores scores{};
+    for (int piece = 0; piece < 12; ++piece) {
+        U64 pieceMask = pieces[piece];
+        while (pieceMask > 0) {
+            const int position = std::countr_zero(pieceMask);
+            scores.material[piece / 6] += pieceOffsetValues[piece % 6];
+            scores.positionBonuses[piece / 6][piece % 6] += getPositionBonus(piece % 6, piece - piece % 6, position);
+            pieceMask &= pieceMask - 1;
+        }
+    }
+    return scores;
+}
+
 bool BitBoard::validSetup() const
 {
     // make sure there is exactly 1 of each king
@@ -1049,7 +1414,7 @@ bool BitBoard::validSetup() const
     }
 
     // make sure all pawns are not in the first or last ranks
-    const auto masks = Masks::getMasks();
+    const auto& masks = Masks::getMasks();
     if (pieces[Piece::P] & masks->rankMasks[0] || pieces[Piece::P] & masks->rankMasks[H8] || pieces[Piece::p] & masks->rankMasks[0] || pieces[Piece::p] & masks->rankMasks[H8]) {
         return false;
     }
@@ -1066,16 +1431,27 @@ bool BitBoard::operator==(const BitBoard& board) const
     return same && (this->temporalInfo == board.temporalInfo);
 }
 
+bool BitBoard::isIdenticalTo(const BitBoard& board) const
+{
+    return *this == board && hashKey == board.hashKey && pawnKey == board.pawnKey && pieceScores == board.pieceScores
+        && halfmoveClock == board.halfmoveClock && fullmoveNumber == board.fullmoveNumber;
+}
+
+bool BitBoard::hasConsistentIncrementalState() const
+{
+    return hashKey == computeHashKey() && pawnKey == computePawnKey() && pieceScores == computePieceScores();
+}
+
 bool BitBoard::needsPawnPromotion() const
 {
-    const auto masks = Masks::getMasks();
+    const auto& masks = Masks::getMasks();
     
     return (pieces[Piece::P] & masks->rankMasks[0] || pieces[Piece::P] & masks->rankMasks[H8] || pieces[Piece::p] & masks->rankMasks[0] || pieces[Piece::p] & masks->rankMasks[H8]);
 }
 
 void BitBoard::applyPawnPromotion(const Piece& newPiece)
 {
-    const auto masks = Masks::getMasks();
+    const auto& masks = Masks::getMasks();
 
     // this is the pawn mask for the player that the piece promotion is being applied to
     const int pawnMask = (newPiece / Piece::k) + Piece::P;
@@ -1086,8 +1462,8 @@ void BitBoard::applyPawnPromotion(const Piece& newPiece)
     const int promotionPosition = std::countr_zero(getPromotedPawn);
 
     // remove the pawn from the board
-    pieces[pawnMask] &= ~(1ull << promotionPosition);
-    pieces[newPiece] |= (1ull << promotionPosition);
+    capturePiece(pawnMask, promotionPosition);
+    placePiece(newPiece, promotionPosition);
 }
 
 BitBoard& BitBoard::operator=(const BitBoard& board)
@@ -1096,6 +1472,11 @@ BitBoard& BitBoard::operator=(const BitBoard& board)
         this->pieces[i] = board.pieces[i];
     }
     this->temporalInfo = board.temporalInfo;
+    this->hashKey = board.hashKey;
+    this->pawnKey = board.pawnKey;
+    this->pieceScores = board.pieceScores;
+    this->halfmoveClock = board.halfmoveClock;
+    this->fullmoveNumber = board.fullmoveNumber;
     return *this;
 }
 
@@ -1105,6 +1486,11 @@ void BitBoard::setBoardToBeEmpty()
         pieces[i] = 0ull;
     }
     temporalInfo = 0;
+    hashKey = 0ull;
+    pawnKey = 0ull;
+    pieceScores = PieceScores{};
+    halfmoveClock = 0;
+    fullmoveNumber = 1;
 }
 
 void BitBoard::manuallySetPlayerTurn(const Player player)
@@ -1114,46 +1500,203 @@ void BitBoard::manuallySetPlayerTurn(const Player player)
     }
 }
 
-//////////////////////////
-// EVALUATION METHODS:
-//////////////////////////
+Player BitBoard::getCurrentPlayer() const
+{
+    return Player(getCurrentPlayerOffset());
+}
 
-U64 BitBoard::pressureRay(const int position, int& bonus, const int incrementAmount, const U64 friendMask, const U64 enemyMask, const std::vector<U64>& masks) const
+// the letter for each piece in FEN, in the same order as the `Piece` enum
+static const std::string fenPieceLetters = "KQBNRPkqbnrp";
+
+std::optional<BitBoard> BitBoard::fromFEN(const std::string& fen)
 {
-    const U64 combinedMask = friendMask | enemyMask;
-    
-    // cast ray
-    for (auto mask : masks) {
-        
-        // this means there was a collision
-        if (combinedMask & mask) {
+    std::istringstream fields{fen};
+    std::string placement, side, castling, enpassant;
+    if (!(fields >> placement >> side >> castling >> enpassant)) {
+        return std::nullopt;
+    }
+    BitBoard board;
+    board.setBoardToBeEmpty();
 
-            return combinedMask & mask;
+    // the placement lists the ranks from the 8th down to the 1st, each from the A file to the H file.
+    // digits count empty tiles, and ranks are separated by slashes
+    int rank = 7;
+    int file = 0;
+    for (const char c : placement) {
+        if (c == '/') {
+            if (file != 8 || rank == 0) {
+                return std::nullopt;
+            }
+            --rank;
+            file = 0;
+        } else if ('1' <= c && c <= '8') {
+            file += c - '0';
+        } else if (fenPieceLetters.find(c) != std::string::npos && file < 8) {
+            board.placePiece(fenPieceLetters.find(c), rank*8 + file);
+            ++file;
+        } else {
+            return std::nullopt;
+        }
+        if (file > 8) {
+            return std::nullopt;
+        }
+    }
+    if (rank != 0 || file != 8) {
+        return std::nullopt;
+    }
 
-        // if there was no collision
+    if (side != "w" && side != "b") {
+        return std::nullopt;
+    }
+    if (side == "b") {
+        board.swapCurrentPlayer();
+    }
+
+    // a pawn on the first or last rank would have to have been promoted
+    const U64 backRanks = 0xFF000000000000FFull;
+    if ((board.pieces[Piece::P] | board.pieces[Piece::p]) & backRanks) {
+        return std::nullopt;
+    }
+
+    // everything else assumes each player has exactly one king, and the player who just moved can not have left theirs in check
+    if (std::popcount(board.pieces[Piece::K]) != 1 || std::popcount(board.pieces[Piece::k]) != 1) {
+        return std::nullopt;
+    }
+    BitBoard otherPlayerToMove{board};
+    otherPlayerToMove.swapCurrentPlayer();
+    if (otherPlayerToMove.isInCheck()) {
+        return std::nullopt;
+    }
+
+    // a castling right needs its king and rook on their starting tiles, since the move generation assumes they are there
+    if (castling != "-") {
+        for (const char c : castling) {
+            if (c == 'K' && (board.pieces[Piece::K] & (1ull << E1)) && (board.pieces[Piece::R] & (1ull << H1))) {
+                board.setTemporalInfo(board.temporalInfo | 0x120000u);
+            } else if (c == 'Q' && (board.pieces[Piece::K] & (1ull << E1)) && (board.pieces[Piece::R] & (1ull << A1))) {
+                board.setTemporalInfo(board.temporalInfo | 0x110000u);
+            } else if (c == 'k' && (board.pieces[Piece::k] & (1ull << E8)) && (board.pieces[Piece::r] & (1ull << H8))) {
+                board.setTemporalInfo(board.temporalInfo | 0x240000u);
+            } else if (c == 'q' && (board.pieces[Piece::k] & (1ull << E8)) && (board.pieces[Piece::r] & (1ull << A8))) {
+                board.setTemporalInfo(board.temporalInfo | 0x280000u);
+            } else if (std::string("KQkq").find(c) == std::string::npos) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    // the en passant tile is the one the pawn that just moved two tiles skipped over
+    if (enpassant != "-") {
+        if (enpassant.size() != 2 || enpassant[0] < 'a' || enpassant[0] > 'h') {
+            return std::nullopt;
+        }
+        const unsigned enpassantFile = enpassant[0] - 'a';
+        const bool whiteMoved = (enpassant[1] == '3' && side == "b");
+        if (!whiteMoved && !(enpassant[1] == '6' && side == "w")) {
+            return std::nullopt;
+        }
+        // the pawn must be where the double push left it, with the tile it skipped and the tile it came from both empty,
+        // since capturing it en passant removes it from there
+        const int skippedPosition = (whiteMoved ? 2 : 5) * 8 + enpassantFile;
+        const int pawnPosition = skippedPosition + (whiteMoved ? 8 : -8);
+        const int originPosition = skippedPosition + (whiteMoved ? -8 : 8);
+        const U64 occupiedMask = board.getPlayerCombinedPieceMask(Player::White) | board.getPlayerCombinedPieceMask(Player::Black);
+        if (!(board.pieces[whiteMoved ? Piece::P : Piece::p] & (1ull << pawnPosition))
+                || (occupiedMask & ((1ull << skippedPosition) | (1ull << originPosition)))) {
+            return std::nullopt;
+        }
+        if (whiteMoved) {
+            board.setWhitePawnEnpassantable(enpassantFile);
         } else {
-            bonus += incrementAmount;
+            board.setBlackPawnEnpassantable(enpassantFile);
         }
     }
-    return 0ull;
+
+    // the counters are optional, since many FEN strings leave them off
+    int halfmoveClock = 0;
+    int fullmoveNumber = 1;
+    if (fields >> halfmoveClock) {
+        if (!(fields >> fullmoveNumber) || halfmoveClock < 0 || fullmoveNumber < 1) {
+            return std::nullopt;
+        }
+    }
+    board.halfmoveClock = halfmoveClock;
+    board.fullmoveNumber = fullmoveNumber;
+    return board;
 }
 
-int BitBoard::getPieceScores(const Player p) const
+std::string BitBoard::toFEN() const
 {
-    std::unordered_map<Piece, int> values = {
-            {Piece::K, KING_VALUE}, {Piece::Q, QUEEN_VALUE}, {Piece::B, BISHOP_VALUE}, {Piece::N, KNIGHT_VALUE}, 
-            {Piece::R, ROOK_VALUE}, {Piece::P, PAWN_VALUE}};
+    std::string fen;
+    for (int rank = 7; rank >= 0; --rank) {
+        int emptyTiles = 0;
+        for (int file = 0; file < 8; ++file) {
+            const int piece = getPiece(Position(rank, file));
+            if (piece >= Piece::DarkNone) {
+                ++emptyTiles;
+                continue;
+            }
+            if (emptyTiles > 0) {
+                fen += static_cast<char>('0' + emptyTiles);
+                emptyTiles = 0;
+            }
+            fen += fenPieceLetters[piece];
+        }
+        if (emptyTiles > 0) {
+            fen += static_cast<char>('0' + emptyTiles);
+        }
+        if (rank > 0) {
+            fen += '/';
+        }
+    }
 
-    int sumScore = 0;
-    for (int i = 0; i < 6; ++i) {
-        sumScore += std::popcount(pieces[p + i]) * values[Piece(i)];
+    fen += (getCurrentPlayerOffset() == Player::White) ? " w " : " b ";
+
+    std::string castling;
+    if (isWhiteRightCastleable()) castling += 'K';
+    if (isWhiteLeftCastleable()) castling += 'Q';
+    if (isBlackRightCastleable()) castling += 'k';
+    if (isBlackLeftCastleable()) castling += 'q';
+    fen += castling.empty() ? "-" : castling;
+
+    std::string enpassant = "-";
+    for (unsigned file = 0; file < 8; ++file) {
+        if (isWhitePawnEnpassantable(file)) {
+            enpassant = {static_cast<char>('a' + file), '3'};
+        } else if (isBlackPawnEnpassantable(file)) {
+            enpassant = {static_cast<char>('a' + file), '6'};
+        }
     }
-    return sumScore;
+    fen += " " + enpassant + " " + std::to_string(halfmoveClock) + " " + std::to_string(fullmoveNumber);
+    return fen;
+}
+
+//////////////////////////
+// EVALUATION METHODS:
+//////////////////////////
+
+U64 BitBoard::pressureRay(int& bonus, const int incrementAmount, const U64 occupiedMask, const U64 attacks)
+{
+    // every attacked tile that is empty is one the ray passed through without a collision
+    bonus += incrementAmount * std::popcount(attacks & ~occupiedMask);
+
+    // the occupied tiles that are attacked are the collisions at the end of each ray
+    return attacks & occupiedMask;
+}
+
+int BitBoard::getPieceScores(const Player p) const
+{
+    return pieceScores.material[p / 6];
+}
+
+int BitBoard::getPositionBonuses(const Player p, const Piece piece) const
+{
+    return pieceScores.positionBonuses[p / 6][piece];
 }
 
 int BitBoard::queenPressureBonus(const Player p) const
 {
-    const auto masks = Masks::getMasks();
+    const auto& masks = Masks::getMasks();
     int bonus = 0;
     const U64 friendMask = getPlayerCombinedPieceMask(p);
     const U64 enemyMask = getPlayerCombinedPieceMask(Player(6-p));
@@ -1162,24 +1705,16 @@ int BitBoard::queenPressureBonus(const Player p) const
 
     const int totalPieceCount = std::popcount(getPlayerCombinedPieceMask(Player::White) | getPlayerCombinedPieceMask(Player::Black));
 
+    // award position bonuses
+    bonus += getPositionBonuses(p, Piece::Q);
+
     // loop through each queen
     while (ourQueens > 0) {
         const int queenPosition = std::countr_zero(ourQueens);
 
         // add on a bonus for the queen being open, and collect the squares its rays collide with
 
-        U64 collisionSquares = 0ull;
-        collisionSquares |= pressureRay(queenPosition, bonus, 1, friendMask, enemyMask, masks->attackRayRight[queenPosition]);
-        collisionSquares |= pressureRay(queenPosition, bonus, 1, friendMask, enemyMask, masks->attackRayDiagonalUpRight[queenPosition]);
-        collisionSquares |= pressureRay(queenPosition, bonus, 1, friendMask, enemyMask, masks->attackRayUp[queenPosition]);
-        collisionSquares |= pressureRay(queenPosition, bonus, 1, friendMask, enemyMask, masks->attackRayDiagonalUpLeft[queenPosition]);
-        collisionSquares |= pressureRay(queenPosition, bonus, 1, friendMask, enemyMask, masks->attackRayLeft[queenPosition]);
-        collisionSquares |= pressureRay(queenPosition, bonus, 1, friendMask, enemyMask, masks->attackRayDiagonalDownLeft[queenPosition]);
-        collisionSquares |= pressureRay(queenPosition, bonus, 1, friendMask, enemyMask, masks->attackRayDown[queenPosition]);
-        collisionSquares |= pressureRay(queenPosition, bonus, 1, friendMask, enemyMask, masks->attackRayDiagonalDownRight[queenPosition]);
-        
-        // award position bonuses
-        bonus += Masks::queenPositionBonus[p/6][queenPosition];
+        const U64 collisionSquares = pressureRay(bonus, 1, friendMask | enemyMask, masks->queenAttacks(queenPosition, friendMask | enemyMask));
 
         // award points for each tile touching the enemy king (or the enemy king itself) that this queen could attack
         bonus += (50-totalPieceCount) * std::popcount(collisionSquares & masks->threeByThreeSquareMask[enemyKingPosition]);
@@ -1191,7 +1726,7 @@ int BitBoard::queenPressureBonus(const Player p) const
 
 int BitBoard::rookPressureBonus(const Player p) const
 {
-    const auto masks = Masks::getMasks();
+    const auto& masks = Masks::getMasks();
     int bonus = 0;
     const U64 friendMask = getPlayerCombinedPieceMask(p);
     const U64 enemyMask = getPlayerCombinedPieceMask(Player(6-p));
@@ -1200,20 +1735,16 @@ int BitBoard::rookPressureBonus(const Player p) const
 
     const int totalPieceCount = std::popcount(getPlayerCombinedPieceMask(Player::White) | getPlayerCombinedPieceMask(Player::Black));
 
+    // award position bonuses
+    bonus += getPositionBonuses(p, Piece::R);
+
     // loop through each rook
     while (ourRooks > 0) {
         const int rookPosition = std::countr_zero(ourRooks);
 
         // add on a bonus for the rook being open, and collect the squares its rays collide with
 
-        U64 collisionSquares = 0ull;
-        collisionSquares |= pressureRay(rookPosition, bonus, 1, friendMask, enemyMask, masks->attackRayRight[rookPosition]);
-        collisionSquares |= pressureRay(rookPosition, bonus, 1, friendMask, enemyMask, masks->attackRayUp[rookPosition]);
-        collisionSquares |= pressureRay(rookPosition, bonus, 1, friendMask, enemyMask, masks->attackRayLeft[rookPosition]);
-        collisionSquares |= pressureRay(rookPosition, bonus, 1, friendMask, enemyMask, masks->attackRayDown[rookPosition]);
-        
-        // award position bonuses
-        bonus += Masks::rookPositionBonus[p/6][rookPosition];
+        const U64 collisionSquares = pressureRay(bonus, 1, friendMask | enemyMask, masks->rookAttacks(rookPosition, friendMask | enemyMask));
 
         // award points for each tile touching the enemy king (or the enemy king itself) that this rook could attack
         bonus += (40-totalPieceCount) * std::popcount(collisionSquares & masks->threeByThreeSquareMask[enemyKingPosition]);
@@ -1225,29 +1756,25 @@ int BitBoard::rookPressureBonus(const Player p) const
 
 int BitBoard::bishopPressureBonus(const Player p) const
 {
-    const auto masks = Masks::getMasks();
+    const auto& masks = Masks::getMasks();
     int bonus = 0;
     const U64 friendMask = getPlayerCombinedPieceMask(p);
     const U64 enemyMask = getPlayerCombinedPieceMask(Player(6-p));
     const int enemyKingPosition = std::countr_zero(pieces[6-p]);
-    U64 ourBishops = pieces[static_cast<int>(p) + Piece::Q];
+    U64 ourBishops = pieces[static_cast<int>(p) + Piece::B];
 
     const int totalPieceCount = std::popcount(getPlayerCombinedPieceMask(Player::White) | getPlayerCombinedPieceMask(Player::Black));
 
+    // award position bonuses
+    bonus += getPositionBonuses(p, Piece::B);
+
     // loop through each bishop
     while (ourBishops > 0) {
         const int bishopPosition = std::countr_zero(ourBishops);
 
         // add on a bonus for the bishop being open, and collect the squares its rays collide with
 
-        U64 collisionSquares = 0ull;
-        collisionSquares |= pressureRay(bishopPosition, bonus, 1, friendMask, enemyMask, masks->attackRayDiagonalUpRight[bishopPosition]);
-        collisionSquares |= pressureRay(bishopPosition, bonus, 1, friendMask, enemyMask, masks->attackRayDiagonalUpLeft[bishopPosition]);
-        collisionSquares |= pressureRay(bishopPosition, bonus, 1, friendMask, enemyMask, masks->attackRayDiagonalDownLeft[bishopPosition]);
-        collisionSquares |= pressureRay(bishopPosition, bonus, 1, friendMask, enemyMask, masks->attackRayDiagonalDownRight[bishopPosition]);
-        
-        // award position bonuses
-        bonus += Masks::bishopPositionBonus[p/6][bishopPosition];
+        const U64 collisionSquares = pressureRay(bonus, 1, friendMask | enemyMask, masks->bishopAttacks(bishopPosition, friendMask | enemyMask));
 
         // award points for each tile touching the enemy king (or the enemy king itself) that this bishop could attack
         bonus += (40-totalPieceCount) * std::popcount(collisionSquares & masks->threeByThreeSquareMask[enemyKingPosition]);
@@ -1259,7 +1786,7 @@ int BitBoard::bishopPressureBonus(const Player p) const
 
 int BitBoard::connectedRooksBonus(const Player p) const
 {
-    const auto masks = Masks::getMasks();
+    const auto& masks = Masks::getMasks();
     int bonus = 0;
     const U64 friendMask = getPlayerCombinedPieceMask(p);
     const U64 enemyMask = getPlayerCombinedPieceMask(Player(6-p));
@@ -1271,11 +1798,7 @@ int BitBoard::connectedRooksBonus(const Player p) const
 
         // add on a bonus for the rook being open, and collect the squares its rays collide with
 
-        U64 collisionSquares = 0ull;
-        collisionSquares |= pressureRay(rookPosition, bonus, 0, friendMask, enemyMask, masks->attackRayRight[rookPosition]);
-        collisionSquares |= pressureRay(rookPosition, bonus, 0, friendMask, enemyMask, masks->attackRayUp[rookPosition]);
-        collisionSquares |= pressureRay(rookPosition, bonus, 0, friendMask, enemyMask, masks->attackRayLeft[rookPosition]);
-        collisionSquares |= pressureRay(rookPosition, bonus, 0, friendMask, enemyMask, masks->attackRayDown[rookPosition]);
+        const U64 collisionSquares = pressureRay(bonus, 0, friendMask | enemyMask, masks->rookAttacks(rookPosition, friendMask | enemyMask));
         
         // award 15 points for each friendly rook that this rook collides with (so, each pair of rook collisions will add 30 points)
         bonus += 15 * std::popcount(collisionSquares & pieces[static_cast<int>(p) + Piece::R]);
@@ -1285,13 +1808,12 @@ int BitBoard::connectedRooksBonus(const Player p) const
     return bonus;
 }
 
-int BitBoard::connectedAndStackedPawnBonus(const Player p) const
+BitBoard::PawnStructure BitBoard::getPawnStructure(const Player p) const
 {
-    const auto masks = Masks::getMasks();
-    int bonus = 0;
-    U64 ourPawns = pieces[static_cast<int>(p) + Piece::P];
-
-    const int totalPieceCount = std::popcount(getPlayerCombinedPieceMask(Player::White) | getPlayerCombinedPieceMask(Player::Black));
+    const auto& masks = Masks::getMasks();
+    PawnStructure structure;
+    const U64 allPawns = pieces[static_cast<int>(p) + Piece::P];
+    U64 ourPawns = allPawns;
 
     // loop through each pawn
     while (ourPawns > 0) {
@@ -1307,59 +1829,63 @@ int BitBoard::connectedAndStackedPawnBonus(const Player p) const
         // everything in the file except for this pawn itself
         const U64 badNeighbourSquares = masks->fileMasks[pawnPosition] & ~(1ull << pawnPosition);
 
-        // don't care about this in the opening
-        if (totalPieceCount > 30) {
-            // add 5 points for any pawns 1 square away on the left or on the right
-            bonus += 5 * std::popcount(goodNeighbourSquares & pieces[static_cast<int>(p) + Piece::P]);
-        }
+        structure.connectedPawns += std::popcount(goodNeighbourSquares & allPawns);
+        structure.stackedPawns += std::popcount(badNeighbourSquares & allPawns);
+        ourPawns &= ~(1ull << pawnPosition);
+    }
 
+    const int whiteValues[8] = {0, 0, 50, 75, 100, 150, 250, 0};
+    const int blackValues[8] = {0, 250, 150, 100, 75, 50, 0, 0};
 
-        // subtract points for stacked pawns, weighted more heavily towards endgame
-        // late game this potentially could subtract ~60 points for 1 pair of stacked pawns
-        bonus -= (32 - totalPieceCount) * std::popcount(badNeighbourSquares & pieces[static_cast<int>(p) + Piece::P]); 
-        ourPawns &= ~(1ull << pawnPosition);
+    // go through the 6 ranks where pawns could possibly be
+    for (int rank = 1; rank < 7; ++rank) {
+        const int pawnsOnThisRank = std::popcount(masks->rankMasks[rank*8] & allPawns);
+        structure.pushedPawnBonus += pawnsOnThisRank * ((p == Player::White) ? whiteValues[rank] : blackValues[rank]);
     }
-    return bonus;
+    return structure;
 }
 
-int BitBoard::activeKnights(const Player p) const
+int BitBoard::connectedAndStackedPawnBonus(const Player p) const
 {
-    const auto masks = Masks::getMasks();
-    int bonus = 0;
-    U64 ourKnights = pieces[static_cast<int>(p) + Piece::N];
+    return connectedAndStackedPawnBonus(getPawnStructure(p));
+}
 
-    // loop through each pawn
-    while (ourKnights > 0) {
-        const int knightPosition = std::countr_zero(ourKnights);
+int BitBoard::connectedAndStackedPawnBonus(const PawnStructure& structure) const
+{
+    const int totalPieceCount = std::popcount(getPlayerCombinedPieceMask(Player::White) | getPlayerCombinedPieceMask(Player::Black));
+    int bonus = 0;
 
-        bonus += Masks::knightPositionBonus[p/6][knightPosition];
-        ourKnights &= ~(1ull << knightPosition);
+    // don't care about this in the opening
+    if (totalPieceCount > 30) {
+        // add 5 points for any pawns 1 square away on the left or on the right
+        bonus += 5 * structure.connectedPawns;
     }
+
+    // subtract points for stacked pawns, weighted more heavily towards endgame
+    // late game this potentially could subtract ~60 points for 1 pair of stacked pawns
+    bonus -= (32 - totalPieceCount) * structure.stackedPawns;
     return bonus;
 }
 
+int BitBoard::activeKnights(const Player p) const
+{
+    return getPositionBonuses(p, Piece::N);
+}
+
 int BitBoard::pushedPawnsLateGame(const Player p) const
 {
-    const auto masks = Masks::getMasks();
-    int bonus = 0;
-    const U64 ourPawns = pieces[static_cast<int>(p) + Piece::P];
+    return pushedPawnsLateGame(getPawnStructure(p));
+}
 
+int BitBoard::pushedPawnsLateGame(const PawnStructure& structure) const
+{
     const int totalPieceCount = std::popcount(getPlayerCombinedPieceMask(Player::White) | getPlayerCombinedPieceMask(Player::Black));
 
     // we only care about this later into a game
     if (totalPieceCount > 16) {
         return 0;
     }
-
-    const int whiteValues[8] = {0, 0, 50, 75, 100, 150, 250, 0};
-    const int blackValues[8] = {0, 250, 150, 100, 75, 50, 0, 0};
-
-    // go through the 6 ranks where pawns could possibly be
-    for (int rank = 1; rank < 7; ++rank) {
-        const int pawnsOnThisRank = std::popcount(masks->rankMasks[rank*8] & ourPawns);
-        bonus += pawnsOnThisRank * ((p == Player::White) ? whiteValues[rank] : blackValues[rank]);
-    }
-    return bonus;
+    return structure.pushedPawnBonus;
 }
 
 int BitBoard::kingPositionEarlyGame(const Player p) const
@@ -4,8 +4,13 @@
 #include <cstdint>
 #include <vector>
 #include <unordered_set>
+#include <string>
+#include <optional>
 #include "BoardState.h"
 #include "Move.h"
+#include "MoveList.h"
+#include "Undo.h"
+#include "Zobrist.h"
 #include "Masks.h"
 
 // Evaluation decorator forward declarations
@@ -22,6 +27,7 @@ class PawnlessEndgame;
 class PawnRelations;
 class PushPawnsLateGame;
 class Hash;
+class PawnHash;
 
 using U64 = uint64_t; 
 
@@ -46,8 +52,44 @@ class BitBoard {
     // bit 22 stores the player's turn; 0 is white, 1 is black.
     uint32_t temporalInfo = 0x3F0000u;
 
+    // the Zobrist hash key of this position (see Zobrist.h). It is kept up to date incrementally as pieces and temporal info change.
+    U64 hashKey = computeHashKey();
+
+    // computes the Zobrist hash key of this position from scratch
+    U64 computeHashKey() const;
+    // the Zobrist hash key of only the pawns of both players, kept up to date like `hashKey`. Positions with the same pawns
+    // have the same pawn key, which is what the pawn hash (see PawnHash) looks them up by
+    U64 pawnKey = computePawnKey();
+    // computes the pawn key from scratch
+    U64 computePawnKey() const;
+
+    // the evaluation terms that only depend on which pieces are where, for each player (indexed by the player's offset / 6).
+    // Like the hash key, they are kept up to date as pieces change, so that evaluation can read them instead of adding them up.
+    struct PieceScores {
+        // the value of all of the player's pieces, including the king (see `getPieceScores`)
+        int material[2];
+        // the position bonuses (such as `Masks::knightPositionBonus`) of all of the player's pieces, by piece offset
+        int positionBonuses[2][6];
+
+        bool operator==(const PieceScores& other) const = default;
+    };
+    PieceScores pieceScores = computePieceScores();
+
+    // computes `pieceScores` from scratch
+    PieceScores computePieceScores() const;
+    // adds the scores of `piece` on `position` to `pieceScores` if `sign` is 1, and takes them away if it is -1
+    inline void updatePieceScores(const int piece, const int position, const int sign);
+
+    // the number of moves since the last capture or pawn move, and the number of the current full move (starting at 1,
+    // and going up after each of Black's moves). These are only kept for FEN, so they are not part of `==` or the hash key.
+    int halfmoveClock = 0;
+    int fullmoveNumber = 1;
+
     // METHODS FOR TEMPORAL INFORMATION
 
+    // sets the temporal info, updating the hash key for every bit that changes. All changes to temporal info should go through this.
+    inline void setTemporalInfo(uint32_t newTemporalInfo);
+
     inline bool isWhitePawnEnpassantable(const unsigned file) const;
     inline bool isBlackPawnEnpassantable(const unsigned file) const;
     inline void setWhitePawnEnpassantable(const unsigned file);
@@ -79,7 +121,12 @@ class BitBoard {
     // METHODS FOR MOVE APPLICATION
 
     inline int findPieceOffset(const Position position, const int otherPlayerOffset) const;
-    inline void movePiece(U64& tile, const Move& m);
+    // these change `pieces`, updating the hash key and piece scores to match. All changes to pieces should go through them
+    // (except `unmakeMove`, which restores the hash key directly).
+    inline void movePiece(const int piece, const Move& m);
+    inline void placePiece(const int piece, const int position);
+    inline void capturePiece(const int piece, const int position);
+
     inline void applyKingMove(const Move& move);
     inline void applyQueenMove(const Move& move);
     inline void applyBishopMove(const Move& move);
@@ -91,67 +138,92 @@ class BitBoard {
 
     inline U64 getPlayerCombinedPieceMask(const Player player) const;
 
-    // takes in a position on the board and a vector of masks (one of the ray masks from the Masks singleton), and casts that ray to find candidate moves
-    inline static void useRayMask(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, const std::vector<U64>& masks);
-
-    // finds the places a bishop could move. It does not take into account checks. Adds the moves to the given `moves` vector.
-    inline static void candidateBishopMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks);
-
-    // finds the places a rook could move. It does not take into account checks. Adds the moves to the given `moves` vector.
-    inline static void candidateRookMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks);
-
-    // finds the places a queen could move. It does not take into account checks. Adds the moves to the given `moves` vector.
-    inline static void candidateQueenMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks);
-
-    // finds the places a pawn could move. It does not take into account checks. Adds the moves to the given `moves` vector.
-    inline void candidatePawnMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, const U64 attackMask, const U64 moveMask) const;
-
-    // finds the places a WHITE pawn could move. It does not take into account checks. Adds the moves to the given `moves` vector.
-    inline void candidateWhitePawnMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks) const;
+    // finds the places a bishop could move or capture. It does not take into account checks, nor what colour the pieces it collides with are.
+    inline static U64 candidateBishopMoves(const Position position, const U64 occupiedMask, const Masks& masks);
 
-    // finds the places a BLACK pawn could move. It does not take into account checks. Adds the moves to the given `moves` vector.
-    inline void candidateBlackPawnMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks) const;
+    // finds the places a rook could move or capture. It does not take into account checks, nor what colour the pieces it collides with are.
+    inline static U64 candidateRookMoves(const Position position, const U64 occupiedMask, const Masks& masks);
 
-    // finds the places a knight could move. It does not take into account checks. Adds the moves to the given `moves` vector.
-    inline static void candidateKnightMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks);
+    // finds the places a queen could move or capture. It does not take into account checks, nor what colour the pieces it collides with are.
+    inline static U64 candidateQueenMoves(const Position position, const U64 occupiedMask, const Masks& masks);
 
-    // finds the places a king could move. It does not take into account checks. Adds the moves to the given `moves` vector.
-    inline static void candidateKingMoves(std::vector<Move>& nonCaptureMoves, std::vector<Move>& captureMoves, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks);
+    // these find where every pawn in `pawns` could move to at once, by shifting the whole mask. They do not take into account checks.
+    // the pushes only go to empty tiles, and `pawnDoublePushes` takes the result of `pawnSinglePushes`.
+    // the captures go to every tile diagonally forward (to the west, towards the A file, or to the east), whatever is on it.
+    inline static U64 pawnSinglePushes(const U64 pawns, const U64 emptyMask, const bool isWhite);
+    inline static U64 pawnDoublePushes(const U64 singlePushes, const U64 emptyMask, const bool isWhite, const Masks& masks);
+    inline static U64 pawnWestCaptures(const U64 pawns, const bool isWhite, const Masks& masks);
+    inline static U64 pawnEastCaptures(const U64 pawns, const bool isWhite, const Masks& masks);
 
-    // like useRayMask, but gets the first enemy piece putting you in check
-    // `nonhostileMask` means friendly pieces, and enemy pieces that can't attack for whatever reason (such as if you are casting a ray to a right,
-    // then an enemy bishop couldn't harm you)
-    inline static void checkRayForCheck(std::vector<Position>& enemyChecks, const U64 nonhostileMask, const U64 attackingEnemyMask, const std::vector<U64>& masks);
+    // returns the tile the current player's pawns can capture en passant onto (if any)
+    inline U64 getEnPassantMask(const bool isWhite) const;
 
-    inline void checkForKnightChecks(std::vector<Position>& enemyChecks, const Position position, const U64 enemyMask, shared_ptr<Masks> masks) const;
-    inline void checkForHorizontalVerticalChecks(std::vector<Position>& enemyChecks, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks) const;
-    inline void checkForDiagonalChecks(std::vector<Position>& enemyChecks, const Position position, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks) const;
-    inline void checkForEnemyKingChecks(std::vector<Position>& enemyChecks, const Position yourKingPosition, shared_ptr<Masks> masks) const;
+    // these add the positions of any enemy pieces of the relevant type that are checking a king at `position` to the `enemyChecks` mask
+    inline void checkForKnightChecks(U64& enemyChecks, const Position position, const U64 enemyMask, const Masks& masks) const;
+    inline void checkForHorizontalVerticalChecks(U64& enemyChecks, const Position position, const U64 friendMask, const U64 enemyMask, const Masks& masks) const;
+    inline void checkForDiagonalChecks(U64& enemyChecks, const Position position, const U64 friendMask, const U64 enemyMask, const Masks& masks) const;
+    inline void checkForEnemyKingChecks(U64& enemyChecks, const Position yourKingPosition, const Masks& masks) const;
 
-    inline bool isKingInCheck(const Position kingPosition, const U64 friendMask, const U64 enemyMask, shared_ptr<Masks> masks) const;
+    inline bool isKingInCheck(const Position kingPosition, const U64 friendMask, const U64 enemyMask, const Masks& masks) const;
 
-    inline bool checkCastleable(const int kingPosition, const int rookPosition, const U64 friendMask, const U64 enemyMask, std::shared_ptr<Masks> masks) const;
+    inline bool checkCastleable(const int kingPosition, const int rookPosition, const U64 friendMask, const U64 enemyMask, const Masks& masks) const;
 
     std::vector<Piece> getPieceList() const;
 
-    inline void applyAllPawnMoves(std::vector<std::shared_ptr<BitBoard>>& result, std::vector<Move>& moves, const int kingPosition, const U64 friendMask, const U64 enemyMask, std::shared_ptr<Masks> masks) const;
-    inline void applyAllBishopMoves(std::vector<std::shared_ptr<BitBoard>>& result, std::vector<Move>& moves, const int kingPosition, const U64 friendMask, const U64 enemyMask, std::shared_ptr<Masks> masks) const;
-    inline void applyAllKnightMoves(std::vector<std::shared_ptr<BitBoard>>& result, std::vector<Move>& moves, const int kingPosition, const U64 friendMask, const U64 enemyMask, std::shared_ptr<Masks> masks) const;
-    inline void applyAllRookMoves(std::vector<std::shared_ptr<BitBoard>>& result, std::vector<Move>& moves, const int kingPosition, const U64 friendMask, const U64 enemyMask, std::shared_ptr<Masks> masks) const;
-    inline void applyAllQueenMoves(std::vector<std::shared_ptr<BitBoard>>& result, std::vector<Move>& moves, const int kingPosition, const U64 friendMask, const U64 enemyMask, std::shared_ptr<Masks> masks) const;
-    inline void applyAllKingMoves(std::vector<std::shared_ptr<BitBoard>>& result, std::vector<Move>& moves, const int kingPosition, const U64 friendMask, const U64 enemyMask, std::shared_ptr<Masks> masks) const;
-
-
+    // these add a move to `moveList` from `start` to each tile in `targets`. The caller must have already left out the moves
+    // that would leave the king in check.
+    inline static void addMoves(MoveList& moveList, const int start, U64 targets, const int flags);
+    // adds a pawn move to each tile in `targets` from the tile `delta` before it, with every promotion for a pawn reaching the last rank.
+    // `flags` (see `PackedMove::Flag`) says what kind of move they are
+    // The caller must have already left out the moves that would leave the king in check.
+    inline static void addPawnTargets(MoveList& moveList, U64 targets, const int delta, const int flags);
+    // like `addPawnTargets` for en passant captures, but skips any that would leave the king in check
+    inline void addEnPassantMoves(MoveList& moveList, U64 targets, const int delta, const int kingPosition, const U64 friendMask, const U64 enemyMask, const Masks& masks) const;
+    // adds a move to `moveList` from the king at `start` to each tile in `targets`, skipping any move that would leave it in check
+    inline void addLegalKingMoves(MoveList& moveList, const int start, U64 targets, const int flags, const U64 friendMask, const U64 enemyMask, const Masks& masks) const;
+
+    // returns the mask of the current player's pieces that are pinned to their king (at `kingPosition`) by an enemy slider
+    inline U64 getPinnedMask(const int kingPosition, const U64 friendMask, const U64 enemyMask, const Masks& masks) const;
+
+    // returns the tiles the current player's piece of type `piece` (which must not be a king or a pawn) at `piecePosition`
+    // can move to, including captures of our own pieces, but keeping a pinned piece on its line to the king
+    inline U64 getPieceTargets(const Piece piece, const int piecePosition, const int kingPosition, const U64 pinnedMask, const U64 occupiedMask, const Masks& masks) const;
+    // adds the legal moves of every one of the current player's pieces of type `piece` (which must not be a king or a pawn)
+    // that end on a tile in `targetMask`, with the given `flags`. `targetMask` should already only have the tiles that deal with any check on the king.
+    inline void addPieceMoves(MoveList& moveList, const Piece piece, const U64 targetMask, const int flags, const int kingPosition, const U64 pinnedMask, const U64 occupiedMask, const Masks& masks) const;
+
+    // adds the moves of the pawns in `pawns` that end on a tile in `allowedMask` (except en passant, which is checked on its own).
+    // Adds capturing moves if `captures` is set, and non-capturing moves otherwise.
+    inline void addPawnMoves(MoveList& moveList, const bool captures, const U64 pawns, const U64 allowedMask, const int kingPosition, const U64 friendMask, const U64 enemyMask, const Masks& masks) const;
+    // adds the legal moves of every one of the current player's pawns, like `addPawnMoves`.
+    // `checkMask` has the tiles that deal with any check on the king
+    inline void addAllPawnMoves(MoveList& moveList, const bool captures, const int kingPosition, const U64 checkMask, const U64 pinnedMask, const U64 friendMask, const U64 enemyMask, const Masks& masks) const;
+    // returns the mask of the pieces of both players that attack `position`, with the pieces in `occupiedMask` blocking sliders.
+    // pieces outside `occupiedMask` are still included, so the caller should mask them out
+    inline U64 getAttackersTo(const int position, const U64 occupiedMask, const Masks& masks) const;
+    // writes the legal moves into `moveList`, which are only the captures and promotions if `capturesOnly` is set (see `generateCaptures`)
+    inline void generateMoves(MoveList& moveList, const bool capturesOnly) const;
+
+    // these count the same moves as the `add` methods above, but from the sizes of the target masks, without writing any moves
+    inline int countLegalKingMoves(const int start, U64 targets, const U64 friendMask, const U64 enemyMask, const Masks& masks) const;
+    inline int countPieceMoves(const Piece piece, const U64 targetMask, const int kingPosition, const U64 pinnedMask, const U64 occupiedMask, const Masks& masks) const;
+    // counts both the pushes and the captures of the pawns in `pawns`, like calling `addPawnMoves` for each
+    inline int countPawnMoves(const U64 pawns, const U64 allowedMask, const int kingPosition, const U64 friendMask, const U64 enemyMask, const Masks& masks) const;
+    // returns the number of legal moves. If `stopAtFirst` is set, it returns as soon as it knows there is at least one,
+    // so the result is then only useful as whether there are any
+    inline int countLegalMoves(const bool stopAtFirst) const;
 
     // METHODS FOR EVALUATION PURPOSES:
 
-    // increments bonus by increment amount for each empty square the ray is cast to, and returns the mask of the first
-    // piece the ray collides with
-    U64 pressureRay(const int position, int& bonus, const int incrementAmount, const U64 friendMask, const U64 enemyMask, const std::vector<U64>& masks) const;
+    // increments bonus by increment amount for each empty square in `attacks` (the tiles a slider attacks),
+    // and returns the mask of the pieces the attacks collide with
+    static U64 pressureRay(int& bonus, const int incrementAmount, const U64 occupiedMask, const U64 attacks);
 
     // basic piece scores:
     // King +1000000, Queen +800, Rook +500, Bishop/Knight +300, Pawn +100
     int getPieceScores(const Player p) const;
+    // returns the sum of the position bonuses of the player's pieces of type `piece` (which is 0 for kings and pawns)
+    int getPositionBonuses(const Player p, const Piece piece) const;
 
     // gives a positive bonus related to how many free tiles these pieces could move to, and also how many tiles near the king they can 
     // move to or capture
@@ -162,15 +234,30 @@ class BitBoard {
     // gives a positive bonus for having rooks in contact with each other
     int connectedRooksBonus(const Player p) const;
 
+    // the parts of the pawn terms below that only depend on where one player's pawns are, so that they can be kept in the
+    // pawn hash (see PawnHash) and shared by every position with the same pawns
+    struct PawnStructure {
+        // the number of the player's pawns beside or diagonal to each of the player's pawns, added up over all their pawns
+        int connectedPawns = 0;
+        // the number of the player's other pawns in the same file as each of the player's pawns, added up over all their pawns
+        int stackedPawns = 0;
+        // the bonus for how far the player's pawns are pushed, before deciding if it is late enough in the game to count
+        int pushedPawnBonus = 0;
+    };
+    // computes the pawn structure of the player from scratch
+    PawnStructure getPawnStructure(const Player p) const;
+
     // gives a positive bonus for pawns being near each other.
     // gives a deduction for having stacked pawns
     int connectedAndStackedPawnBonus(const Player p) const;
+    int connectedAndStackedPawnBonus(const PawnStructure& structure) const;
 
     // gives a positive bonus for having knights near the middle
     int activeKnights(const Player p) const;
 
     // gives a bonus for having pushed pawns late game
     int pushedPawnsLateGame(const Player p) const;
+    int pushedPawnsLateGame(const PawnStructure& structure) const;
 
     // early game, kings get a bonus for being safe away from the board centre. Late game, kings get a bonus for being away from it.
     int kingPositionEarlyGame(const Player p) const;
@@ -194,6 +281,7 @@ class BitBoard {
     friend PushPawnsLateGame;
     friend PawnlessEndgame;
     friend Hash;
+    friend PawnHash;
 public:
 
     BitBoard() = default;
@@ -210,12 +298,18 @@ public:
     // returns all essential info in setup mode
     BoardState getStateSetup() const;
 
+    // returns the legal move from `move.start` to `move.end` (promoting into `promotion`, if given), or nothing if there is none
+    std::optional<PackedMove> findLegalMove(const Move& move, const Piece promotion = Piece::DarkNone) const;
+
     // returns if a move is allowed to be played in the current position
     bool isValidMove(const Move& move) const;
+    // returns if a move promoting a pawn into `piece` (which must be the current player's) is allowed to be played in the current position
+    bool isValidPromotionMove(const Move& move, const Piece piece) const;
 
     // make a move for a human player
     // precondition: the move is valid
     void makePlayerMove(const Move& move);
+    void makePlayerPromotionMove(const Move& move, const Piece piece);
 
     // get which piece is at a position
     Piece getPiece(const Position& position) const;
@@ -228,6 +322,11 @@ public:
     // remove the piece at a position
     void removePiece(const Position& position);
 
+    // returns the Zobrist hash key of this position, which covers the pieces, castling rights, en passant and the player's turn
+    U64 getHashKey() const;
+    // returns the Zobrist hash key of only the pawns in this position
+    U64 getPawnKey() const;
+
     // Check if a setup is valid according to the project specifications.
     // There are real positions in chess that are valid despite this function saying they are not,
     // such as a position where a piece is in check.
@@ -244,6 +343,65 @@ public:
     void applyPawnPromotion(const Piece& newPiece);
 
     bool operator==(const BitBoard& board) const;
+    // returns if this board is exactly the same as `board`: unlike `==`, which only compares the position, this also
+    // compares the hash keys, the piece scores and the move counters
+    bool isIdenticalTo(const BitBoard& board) const;
+    // returns if the hash keys and piece scores, which are kept up to date as moves are made, match what computing them
+    // from scratch gives
+    bool hasConsistentIncrementalState() const;
+
+    // writes every legal move in the current position into `moveList` (clearing it first).
+    // moves are ordered such that the ones more likely to be better come first.
+    void generateMoves(MoveList& moveList) const;
+    // like `generateMoves`, but only writes the captures and promotions, for the quiescence search.
+    // when the current player is in check it writes every legal move instead, since all of them are ways out of the check
+    void generateCaptures(MoveList& moveList) const;
+    // returns if the current player's king is in check
+    bool isInCheck() const;
+    // returns if the current player has a legal move, stopping at the first one it finds
+    bool hasAnyLegalMove() const;
+    // returns the number of legal moves, the same as the size of the list from `generateMoves`, without writing them
+    int countLegalMoves() const;
+    // returns if neither player has enough pieces left to ever checkmate (a king alone, a king and one bishop or knight against
+    // a king, or a king and bishop against a king and bishop on the same colour of tile), which is a draw
+    bool hasInsufficientMaterial() const;
+
+    // the value of each piece offset (see the `Piece` enum) in the static exchange evaluation. The king is worth far more than
+    // anything it could win, so that it is never traded off
+    static constexpr int seeValues[6] = {20000, 900, 330, 320, 500, 100};
+    // returns the material the current player wins (or loses, if negative) by making the capture `move` and then having both
+    // players keep recapturing on its ending tile with their least valuable piece, each stopping whenever that is better for them.
+    // This is the static exchange evaluation (SEE), which tells whether a capture wins material without searching it.
+    // Pieces behind a slider are found once the slider leaves the line (x-rays), but pins are ignored.
+    // precondition: the move is legal in the current position
+    int see(const PackedMove move) const;
+
+    // applies a move produced by `generateMoves`, including castling and promotion, and passes the turn
+    // precondition: the move is legal in the current position
+    void applyMove(const PackedMove move);
+
+    // applies a move like `applyMove`, but returns what is needed to take the move back with `unmakeMove`.
+    // this allows a search to walk a single board in place instead of copying it for every child.
+    // precondition: the move is legal in the current position
+    Undo makeMove(const PackedMove move);
+
+    // takes back a move made with `makeMove`, restoring the board exactly
+    // precondition: `move` was the last move made on this board, and `undo` is what making it returned
+    void unmakeMove(const PackedMove move, const Undo& undo);
+
+    // passes the turn without moving anything (a "null move"), which is not a legal move, but lets the search ask how good
+    // the position would be if the current player could skip their turn. Returns what `unmakeNullMove` needs to take it back.
+    // precondition: the current player is not in check
+    Undo makeNullMove();
+    // takes back a null move made with `makeNullMove`
+    void unmakeNullMove(const Undo& undo);
+
+    // returns if `player` has any pieces other than their king and pawns
+    bool hasNonPawnMaterial(const Player player) const;
+    // returns if there are no pawns on the board, which is when the mop-up evaluation can apply (see `mopupEvaluationBonus`)
+    bool isPawnless() const;
+
+    // returns a new board for every legal move in the current position, in the same order as `generateMoves`
     std::vector<std::shared_ptr<BitBoard>> generateValidNextPositions() const;
 
     // this removes all pieces, and sets all temporal information to 0 (disables castling rights and sets player to white)
@@ -251,6 +409,17 @@ public:
 
     // this sets the player's turn to the `player` parameter.
     void manuallySetPlayerTurn(const Player player);
+
+    // returns the player whose turn it is
+    Player getCurrentPlayer() const;
+
+    // returns the board described by a FEN string, or nothing if it is not valid FEN. The halfmove and fullmove
+    // counters may be left off. Castling rights are only kept for a king and rook that are on their starting tiles.
+    // A position without exactly one king for each player, with a pawn on the first or last rank, or where the player who just
+    // moved is in check, is not valid, and neither is an en passant tile that no enemy pawn just skipped over.
+    static std::optional<BitBoard> fromFEN(const std::string& fen);
+    // returns the FEN string describing this board
+    std::string toFEN() const;
 };
 
 #endif
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "BoardSubject.h"
 
 void BoardSubject::attach(std::shared_ptr<DisplayObserver> o) 
@@ -98,7 +98,7 @@ void ChessController::runController()
                 std::cout << "Invalid input for black-player to start a new game." << std::endl;
                 continue;
             }
-            game = Game{board, currentTurn, whiteType, blackType};
+            game = Game{board, currentTurn, whiteType, blackType, hashSizeMB, searchLimits, threads, ponder};
             board->notifyObservers(); // notify the display 
             setGame = true;
         } else if (cmd == "resign") {
@@ -191,6 +191,12 @@ void ChessController::runController()
             }
             currentTurn = Player(6 - currentTurn);
             currentTurn = playAutomatic(game, currentTurn, isWhiteHuman, isBlackHuman); // play computer automatically if compiler flag is set
+        } else if (cmd == "fen") {
+            if (numberArg(line) != 1) {
+                std::cout << "Too many arguments to fen." << std::endl;
+                continue;
+            }
+            std::cout << board->getBitBoard().toFEN() << std::endl;
         } else if (cmd == "setup") {
             // check for the number of arguments
             if (numberArg(line) != 1) {
@@ -290,6 +296,17 @@ void ChessController::runController()
                         std::cout << "Invalid colour. Please input White or Black." << std::endl;
                         continue;
                     }
+                } else if (cmd2 == "fen") {
+                    // replaces the whole board with the position from a FEN string
+                    std::string fen;
+                    std::getline(setupss, fen);
+                    const auto fenBoard = BitBoard::fromFEN(fen);
+                    if (!fenBoard) {
+                        std::cout << "Invalid FEN." << std::endl;
+                        continue;
+                    }
+                    board->setBitBoard(*fenBoard);
+                    currentTurn = fenBoard->getCurrentPlayer();
                 } else if (cmd2 == "done") {
                     // check for the number of arguments
                     if (numberArg(setupline) != 1) {
@@ -330,6 +347,27 @@ void ChessController::setAutomatic()
     automatic = true;
 }
 
+// let computers think on their opponent's time
+void ChessController::setPonder()
+{
+    ponder = true;
+}
+
+void ChessController::setHashSize(const int megabytes)
+{
+    hashSizeMB = megabytes;
+}
+
+void ChessController::setSearchLimits(const SearchLimits& limits)
+{
+    searchLimits = limits;
+}
+
+void ChessController::setThreads(const int threadCount)
+{
+    threads = threadCount;
+}
+
 Player ChessController::playAutomatic(Game& game, int currentTurn, bool isWhiteHuman, bool isBlackHuman)
 {
     while (!game.isGameOver() && automatic && ((currentTurn == Player::White && !isWhiteHuman) || (currentTurn == Player::Black && !isBlackHuman))) {
@@ -3,11 +3,21 @@
 
 #include <iostream>
 #include "Player.h"
+#include "Hash.h"
+#include "SearchLimits.h"
 
 class GameBoard;
 class Game;
 class ChessController {
     bool automatic = false;
+    // if computer players think during a human's turn
+    bool ponder = false;
+    // the size of the transposition table given to each computer player
+    int hashSizeMB = Hash::defaultSizeMB;
+    // how long computer players may think about each move
+    SearchLimits searchLimits;
+    // the number of threads each computer player searches with
+    int threads = 1;
 
     Player playAutomatic(Game& game, int currentTurn, bool isWhiteHuman, bool isBlackHuman);
     bool isValidPosition(const std::string position) const;
@@ -18,6 +28,10 @@ public:
 
     // extra features
     void setAutomatic();
+    void setPonder();
+    void setHashSize(const int megabytes);
+    void setSearchLimits(const SearchLimits& limits);
+    void setThreads(const int threadCount);
 };
 
 #endif
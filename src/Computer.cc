@@ -2,221 +2,650 @@
 #include <numeric>
 #include <algorithm>
 #include <random>
-#include "./Evaluation/Level1.h"
-#include "./Evaluation/Level2.h"
-#include "./Evaluation/Level3.h"
-#include "./Evaluation/GameOver.h"
-#include "./Evaluation/ActiveKnights.h"
-#include "./Evaluation/BishopPressure.h"
-#include "./Evaluation/ConnectedRooks.h"
-#include "./Evaluation/EarlyGameKingPosition.h"
-#include "./Evaluation/PawnlessEndgame.h"
-#include "./Evaluation/PawnRelations.h"
-#include "./Evaluation/PushPawnsLateGame.h"
-#include "./Evaluation/QueenPressure.h"
-#include "./Evaluation/RookPressure.h"
-#include "./Evaluation/Level4Base.h"
+#include <thread>
+#include "./Evaluation/LevelEvaluators.h"
+#include "./Evaluation/PawnHash.h"
 
 std::unique_ptr<Evaluator> Computer::setEvaluator() const
 {
     if (level == 1) {
-        return std::make_unique<Level1>();
+        return std::make_unique<Level1Evaluator>();
     } else if (level == 2) {
-        return std::make_unique<Level2>();
+        return std::make_unique<Level2Evaluator>();
     } else if (level == 3) {
-        return std::make_unique<Level3>(std::make_unique<Level2>());
+        return std::make_unique<Level3Evaluator>();
     } else {
-        return std::make_unique<GameOver>(
-            std::make_unique<EarlyGameKingPosition>(
-                std::make_unique<ActiveKnights>(
-                    std::make_unique<BishopPressure>(
-                        std::make_unique<ConnectedRooks>(
-                            std::make_unique<PawnlessEndgame>(
-                                std::make_unique<PawnRelations>(
-                                    std::make_unique<PushPawnsLateGame>(
-                                        std::make_unique<QueenPressure>(
-                                            std::make_unique<RookPressure>(
-                                                std::make_unique<Level4Base>()
-                                            )
-                                        )
-                                    )
-                                )
-                            )
-                        )
-                    )
-                )
-            )
-        );
-    }
-}
-
-Computer::Computer(Player player, int level): player{player}, level{level}, evaluator{setEvaluator()} {}
-
-Computer::Computer(const Computer& other): player{other.player}, level{other.level}, evaluator{setEvaluator()} {}
-
-std::shared_ptr<BitBoard> Computer::findMove(const BitBoard& board)
-{
-    std::vector<std::shared_ptr<BitBoard>> nextMoves = getMoves(board);
-    int chosenMax = INT_MIN;
-    if (pruneMode) {
-        alphaMax.push(chosenMax);
-    }
-    std::shared_ptr<BitBoard> chosenBoard;
-
-    hash.clearHashTables();
-    
-    // shuffle the input moves for level 2 and 3 to lead to more interesting games
-    if (2 <= level && level <= 3) {
-        auto rd = std::random_device{};
-        auto rng = std::default_random_engine{rd()};
-        std::shuffle(nextMoves.begin(), nextMoves.end(), rng);
-    }
-
-    int recursiveDepth = searchDepth;
-    if (nextMoves.size() < 8) {
-        ++recursiveDepth;
-    } 
-    if (nextMoves.size() < 3) {
-        ++recursiveDepth;
-    }
-
-    for (const auto& nextMove : nextMoves) {
-        
-        // check the eval of this board and update as needed
-        const int currValue = ((level <= 3) ? getAdjustedScore(basicEvalScore(*nextMove), player) : minPlayer(*nextMove, recursiveDepth - 1));
-        if (currValue > chosenMax) {
-            chosenMax = currValue;
-            chosenBoard = nextMove;
-            // keep our max accurate for maximal pruning
-            if (pruneMode) {
-                alphaMax.pop();
-                alphaMax.push(chosenMax);
-            }
-        }
+        return std::make_unique<Level4Evaluator>();
     }
-    alphaMax.pop();
-    return chosenBoard;
 }
 
-int Computer::getAdjustedScore(const int score, const Player player) const
+Computer::Computer(Player player, int level, int hashSizeMB, int threads): player{player}, level{level}, workers(std::max(1, threads)), hash{hashSizeMB}
 {
-    if (player == Player::White) {
-        return score;
-    } else {
-        return -score;
+    for (auto& worker : workers) {
+        worker.evaluator = setEvaluator();
     }
+    workers[0].isMain = true;
 }
 
-int Computer::basicEvalScore(const BitBoard& board) const
+Computer::Computer(const Computer& other): Computer{other.player, other.level, other.hash.getSizeMB(), static_cast<int>(other.workers.size())} {}
+
+std::shared_ptr<BitBoard> Computer::findMove(const BitBoard& board, const SearchLimits& limits)
 {
-    return evaluator->computeEval(board, player).evaluation;
+    const PackedMove move = findBestMove(board, limits);
+    if (move.data == 0) {
+        return nullptr;
+    }
+    auto chosenBoard = std::make_shared<BitBoard>(board);
+    chosenBoard->applyMove(move);
+    return chosenBoard;
 }
 
-std::vector<U64> Computer::candidateHashs(const BitBoard& curr, const int depth) const
+PackedMove Computer::findBestMove(const BitBoard& board, const SearchLimits& limits)
 {
-    // get the hashs for all the depths remaining greater than or equal the current
-    std::vector<U64> options;
-    for (int tryDepth = searchDepth+2; tryDepth >= depth; --tryDepth) {
-        options.push_back(hash.getHashKey(curr, tryDepth));
-    }
-    return options;
+    beginSearch(limits);
+    return runSearch(board, limits);
 }
 
-int Computer::maxPlayer(const BitBoard& curr, const int depthRemaining)
+void Computer::beginSearch(const SearchLimits& limits)
 {
-    const std::vector<U64> options = candidateHashs(curr, depthRemaining);
-    for (const auto option : options) {
-        if (hash.keyExists(option, true)) {
-            return hash.getValue(option, true);
+    // the table is kept between moves, but entries from earlier searches become the first to be replaced
+    hash.newSearch();
+    startClock(limits);
+}
+
+PackedMove Computer::runSearch(const BitBoard& board, const SearchLimits& limits)
+{
+    MoveList nextMoves;
+    board.generateMoves(nextMoves);
+    if (nextMoves.empty()) {
+        return PackedMove{};
+    }
+
+    // levels 1 to 3 only look at the position right after each move
+    if (level <= 3) {
+        // shuffle the input moves for level 2 and 3 to lead to more interesting games
+        if (level >= 2) {
+            auto rd = std::random_device{};
+            auto rng = std::default_random_engine{rd()};
+            std::shuffle(nextMoves.begin(), nextMoves.end(), rng);
+        }
+        int chosenMax = -infinity;
+        PackedMove chosenMove{};
+        BitBoard nextBoard{board};
+        for (const auto move : nextMoves) {
+            const Undo undo = nextBoard.makeMove(move);
+            const int currValue = getAdjustedScore(basicEvalScore(nextBoard), player);
+            nextBoard.unmakeMove(move, undo);
+            if (currValue > chosenMax) {
+                chosenMax = currValue;
+                chosenMove = move;
+            }
         }
+        return chosenMove;
     }
-    const EvalScore evalScore = evaluator->computeEval(curr, player);
-    if (evalScore.gameOver) {
-        const int adjustedScore = getAdjustedScore(evalScore.evaluation, player);
 
-        if (adjustedScore == 0) {
-            return 0;
+    // without any limits, search to our default depth, going deeper when there are only a few moves to look at
+    int maxDepth = maxSearchDepth;
+    if (limits.depth > 0) {
+        maxDepth = limits.depth;
+    } else if (!limits.hasAnyLimit()) {
+        maxDepth = searchDepth;
+        if (nextMoves.size() < 8) {
+            ++maxDepth;
+        } 
+        if (nextMoves.size() < 3) {
+            ++maxDepth;
+        }
+    }
 
-        // increase the score if we are close to checkmate (regardless of the player, put it towards their magnitude)
-        } else {
-            if (adjustedScore > 0) {
-                return adjustedScore + depthRemaining;
+    // the move ordering tables are kept between searches, but what they learned matters less as the game moves on
+    for (auto& worker : workers) {
+        worker.moveHistory.age();
+    }
+    // the main thread evaluates on this thread, so its pawn hash is this thread's, which is kept between searches
+    PawnHash::forThisThread().resetStatistics();
+
+    // order the root moves the same way as every other position's, starting from the best move an earlier search of this
+    // position found (if there was one)
+    HashEntry entry;
+    hash.probe(board.getHashKey(), entry);
+    MovePicker picker{board, entry.bestMove, workers[0].moveHistory, 0, PackedMove{}};
+    nextMoves.clear();
+    for (PackedMove move = picker.nextMove(); move.data != 0; move = picker.nextMove()) {
+        nextMoves.push(move);
+    }
+    if (nextMoves.size() == 1) {
+        maxDepth = 0;
+    }
+
+    // odd helpers start one iteration deeper than the main thread, so that the helpers do not all search in step with it
+    std::vector<std::thread> helperThreads;
+    for (size_t i = 1; i < workers.size(); ++i) {
+        helperThreads.emplace_back([this, &board, &nextMoves, maxDepth, i]() {
+            iterativeDeepening(workers[i], board, nextMoves, 1 + i % 2, maxDepth);
+        });
+    }
+    const PackedMove chosenMove = iterativeDeepening(workers[0], board, nextMoves, 1, maxDepth);
+    stopped = true;
+    for (auto& thread : helperThreads) {
+        thread.join();
+    }
+    // with only one move to play there is no iteration to give a line, but the move itself is still known
+    if (principalVariation.empty() || !(principalVariation[0] == chosenMove)) {
+        principalVariation = {chosenMove};
+    }
+    return chosenMove;
+}
+
+PackedMove Computer::iterativeDeepening(SearchWorker& worker, const BitBoard& board, MoveList rootMoves, const int startDepth, const int maxDepth)
+{
+    PackedMove chosenMove = rootMoves[0];
+    int lastScore = 0;
+    worker.hasSearchedMove = false;
+
+    // the search walks this single board in place, making and unmaking moves on it
+    BitBoard searchBoard{board};
+    for (int depth = startDepth; depth <= maxDepth; ++depth) {
+        // the next iteration takes several times longer than this one, so do not start it if it will likely be cut off
+        if (worker.isMain && depth > 1 && isPastDeadline(softDeadline)) {
+            break;
+        }
+
+        // the best move from the last iteration is searched first, so that the rest can be pruned against it
+        moveToFront(rootMoves, chosenMove);
+
+        // the first iterations are too unsettled (and too quick) to be worth narrowing, and a checkmate's score changes
+        // from one iteration to the next by more than any window
+        const bool useAspiration = pruneMode && depth >= 4 && std::abs(lastScore) < mateThreshold;
+        int window = aspirationWindow;
+        int alpha = useAspiration ? lastScore - window : -infinity;
+        int beta = useAspiration ? lastScore + window : infinity;
+        int score = 0;
+        while (true) {
+            PackedMove iterationMove{};
+            score = searchRoot(worker, searchBoard, rootMoves, depth, alpha, beta, iterationMove);
+            // a move that scored above alpha beat every move searched before it (including the last iteration's best),
+            // so it is kept even if the iteration is cut off
+            if (iterationMove.data != 0) {
+                chosenMove = iterationMove;
+                moveToFront(rootMoves, chosenMove);
+            }
+            if (isStopped(worker)) {
+                break;
+            }
+
+            // the score is only a bound if it fell outside the window, so widen that side and search again
+            if (score <= alpha) {
+                alpha = std::max(score - window, -infinity);
+            } else if (score >= beta) {
+                beta = std::min(score + window, infinity);
             } else {
-                return adjustedScore - depthRemaining;
+                break;
+            }
+            window *= 2;
+        }
+        if (isStopped(worker)) {
+            break;
+        }
+        lastScore = score;
+        worker.hasSearchedMove = true;
+        hash.store(board.getHashKey(), score, depth, Bound::Exact, chosenMove);
+        if (worker.isMain) {
+            principalVariation.assign(worker.pvLines[0], worker.pvLines[0] + worker.pvLengths[0]);
+            reportIteration(depth, score);
+
+            // iterations find the quickest checkmate first, so once we have one there is nothing better to look for
+            if (score >= mateThreshold && !infiniteSearch) {
+                break;
+            }
+        }
+    }
+    return chosenMove;
+}
+
+int Computer::searchRoot(SearchWorker& worker, BitBoard& board, const MoveList& rootMoves, const int depth, int alpha, const int beta, PackedMove& bestMove)
+{
+    worker.pvLengths[0] = 0;
+    int bestScore = -infinity;
+    bool firstMove = true;
+    for (const auto move : rootMoves) {
+        const Undo undo = board.makeMove(move);
+        int currValue;
+        if (firstMove || !pruneMode) {
+            currValue = -negamax(worker, board, depth - 1, -beta, -alpha, 1, move);
+        } else {
+            // later moves only need to be shown to be no better than the best so far
+            currValue = -negamax(worker, board, depth - 1, -alpha - 1, -alpha, 1, move);
+            if (currValue > alpha && currValue < beta) {
+                currValue = -negamax(worker, board, depth - 1, -beta, -alpha, 1, move);
             }
         }
+        board.unmakeMove(move, undo);
+        firstMove = false;
+        if (isStopped(worker)) {
+            break;
+        }
+        if (currValue > bestScore) {
+            bestScore = currValue;
+        }
+        if (currValue > alpha) {
+            alpha = currValue;
+            bestMove = move;
+            worker.updatePrincipalVariation(0, move);
+        }
+        if (alpha >= beta) {
+            break;
+        }
     }
-    // base case: we get our adjusted board evaluation
-    if (depthRemaining == 0) {
-        return getAdjustedScore(evalScore.evaluation, player);
+    return bestScore;
+}
+
+void Computer::reportIteration(const int depth, const int score)
+{
+    if (!infoCallback) {
+        return;
     }
-    std::vector<std::shared_ptr<BitBoard>> children = getMoves(curr);
-    int maxMove = INT_MIN;
-    if (pruneMode) {
-        alphaMax.push(INT_MIN);
+    SearchInfo info;
+    info.depth = depth;
+    info.score = score;
+    info.nodes = getNodes();
+    info.milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - searchStart).count();
+    info.principalVariation = principalVariation;
+    info.pawnHashHitRate = PawnHash::forThisThread().getHitRate();
+
+    // a checkmate's score is lowered by the plies it takes from the root (see `mateScore`)
+    if (std::abs(score) >= mateThreshold) {
+        const int pliesToMate = mateScore - std::abs(score);
+        info.mateIn = (score > 0) ? (pliesToMate + 1) / 2 : -(pliesToMate / 2);
     }
-    for (const auto& child : children) {
-        int currValue = minPlayer(*child, depthRemaining - 1);
-        if (currValue > maxMove) {
-            maxMove = currValue;
-            if (pruneMode) {
-                alphaMax.pop();
-                alphaMax.push(maxMove);
-            }
+    infoCallback(info);
+}
+
+std::vector<PackedMove> Computer::getPrincipalVariation() const
+{
+    return principalVariation;
+}
+
+PackedMove Computer::getPonderMove(const PackedMove move) const
+{
+    if (principalVariation.size() >= 2 && principalVariation[0] == move) {
+        return principalVariation[1];
+    }
+    return PackedMove{};
+}
+
+void Computer::SearchWorker::updatePrincipalVariation(const int ply, const PackedMove move)
+{
+    pvLines[ply][0] = move;
+    std::copy(pvLines[ply + 1], pvLines[ply + 1] + pvLengths[ply + 1], pvLines[ply] + 1);
+    pvLengths[ply] = pvLengths[ply + 1] + 1;
+}
+
+void Computer::stop()
+{
+    stopped = true;
+}
+
+void Computer::ponderHit()
+{
+    // the deadlines are only read once `pondering` is seen to be false, so they must be set before it is
+    setDeadlines();
+    pondering.store(false, std::memory_order_release);
+}
+
+void Computer::setNullMovePruning(const bool enabled)
+{
+    nullMovePruning = enabled;
+}
+
+void Computer::setLateMoveReductions(const bool enabled)
+{
+    lateMoveReductions = enabled;
+}
+
+void Computer::setInfoCallback(std::function<void(const SearchInfo&)> callback)
+{
+    infoCallback = callback;
+}
+
+U64 Computer::getNodes() const
+{
+    U64 nodes = 0;
+    for (const auto& worker : workers) {
+        nodes += worker.nodes.load(std::memory_order_relaxed);
+    }
+    return nodes;
+}
+
+void Computer::clearHash()
+{
+    hash.clear();
+    evalCache.clear();
+    for (auto& worker : workers) {
+        worker.moveHistory.clear();
+    }
+}
+
+void Computer::startClock(const SearchLimits& limits)
+{
+    searchStart = std::chrono::steady_clock::now();
+    stopped = false;
+    for (auto& worker : workers) {
+        worker.nodes = 0;
+    }
+    searchLimits = limits;
+    principalVariation.clear();
+    nodeLimit = limits.nodes;
+    infiniteSearch = limits.infinite;
+    pondering = limits.ponder;
+    if (!limits.ponder) {
+        setDeadlines();
+    }
+}
+
+void Computer::setDeadlines()
+{
+    using namespace std::chrono;
+    const auto now = steady_clock::now();
+    const SearchLimits& limits = searchLimits;
+    timeLimited = limits.hasTimeLimit();
+    if (limits.moveTime > 0) {
+        // an iteration usually takes a few times longer than the last, so one started after half our time is unlikely to finish
+        softDeadline = now + milliseconds(limits.moveTime / 2);
+        hardDeadline = now + milliseconds(limits.moveTime);
+    } else if (limits.time > 0) {
+        // plan to spend a small share of the clock on each move, plus most of the increment we get back for it.
+        // we may go over that when an iteration runs long, but never use more than a fifth of what is left
+        const int safetyMargin = std::min(50, limits.time / 10);
+        const int planned = limits.time / 30 + limits.increment * 3 / 4;
+        const int maximum = std::max(1, std::min((limits.time - safetyMargin) / 5 + limits.increment * 3 / 4, limits.time - safetyMargin));
+        softDeadline = now + milliseconds(std::min(planned, maximum) / 2);
+        hardDeadline = now + milliseconds(maximum);
+    }
+}
+
+bool Computer::isStopped(const SearchWorker& worker) const
+{
+    return stopped.load(std::memory_order_relaxed) && (worker.hasSearchedMove || !worker.isMain);
+}
+
+void Computer::checkTime(SearchWorker& worker)
+{
+    // only this thread writes its count, so it does not need an (expensive) atomic increment
+    const U64 nodes = worker.nodes.load(std::memory_order_relaxed) + 1;
+    worker.nodes.store(nodes, std::memory_order_relaxed);
+
+    // reading the clock is slow compared to visiting a position, so only do it every 1024 positions
+    if (worker.isMain && (nodes & 1023) == 0) {
+        if (isPastDeadline(hardDeadline) || (nodeLimit > 0 && nodes >= nodeLimit)) {
+            stopped = true;
         }
     }
-    alphaMax.pop();
-    hash.setKeyValue(options[options.size() - 1], maxMove, true);
-    return maxMove;
 }
 
-int Computer::minPlayer(const BitBoard& curr, const int depthRemaining)
+bool Computer::isPastDeadline(const std::chrono::steady_clock::time_point& deadline) const
+{
+    // while pondering, the clock has not started yet
+    if (pondering.load(std::memory_order_acquire)) {
+        return false;
+    }
+    return timeLimited && std::chrono::steady_clock::now() >= deadline;
+}
+
+void Computer::moveToFront(MoveList& moves, const PackedMove move)
+{
+    auto found = std::find(moves.begin(), moves.end(), move);
+    if (found != moves.end()) {
+        std::rotate(moves.begin(), found, found + 1);
+    }
+}
+
+bool Computer::isQuiet(const PackedMove move)
+{
+    return !move.isCapture() && !move.isPromotion();
+}
+
+int Computer::mateDistanceScore(const int score, const int ply)
+{
+    if (score > 0) {
+        return mateScore - ply;
+    } else if (score < 0) {
+        return -(mateScore - ply);
+    }
+    return 0;
+}
+
+int Computer::scoreToHash(const int score, const int ply)
 {
-    std::vector<U64> options = candidateHashs(curr, depthRemaining);
-    for (auto option : options) {
-        if (hash.keyExists(option, false)) {
-            return hash.getValue(option, false);
+    if (score >= mateThreshold) {
+        return score + ply;
+    } else if (score <= -mateThreshold) {
+        return score - ply;
+    }
+    return score;
+}
+
+int Computer::scoreFromHash(const int score, const int ply)
+{
+    if (score >= mateThreshold) {
+        return score - ply;
+    } else if (score <= -mateThreshold) {
+        return score + ply;
+    }
+    return score;
+}
+
+int Computer::getAdjustedScore(const int score, const Player player) const
+{
+    if (player == Player::White) {
+        return score;
+    } else {
+        return -score;
+    }
+}
+
+EvalScore Computer::evaluate(SearchWorker& worker, const BitBoard& board)
+{
+    EvalScore score;
+    if (!evalCache.probe(board.getHashKey(), score)) {
+        score = worker.evaluator->computeEval(board, player);
+        evalCache.store(board.getHashKey(), score);
+    }
+    return score;
+}
+
+int Computer::basicEvalScore(const BitBoard& board) const
+{
+    return workers[0].evaluator->computeEval(board, player).evaluation;
+}
+
+int Computer::negamax(SearchWorker& worker, BitBoard& curr, const int depthRemaining, int alpha, const int beta, const int ply, const PackedMove previousMove)
+{
+    worker.pvLengths[ply] = 0;
+    // base case: rather than trusting the evaluation in the middle of an exchange, play out the captures first
+    if (depthRemaining <= 0) {
+        return quiescence(worker, curr, alpha, beta, ply);
+    }
+
+    checkTime(worker);
+    if (isStopped(worker)) {
+        return 0;
+    }
+
+    // a stored score can be used directly if it is exact, or if its bound already puts it outside our window
+    HashEntry entry;
+    const bool hashHit = hash.probe(curr.getHashKey(), entry);
+    if (hashHit && entry.depth >= depthRemaining) {
+        const int hashScore = scoreFromHash(entry.score, ply);
+        if (entry.bound == Bound::Exact
+                || (entry.bound == Bound::Lower && hashScore >= beta)
+                || (entry.bound == Bound::Upper && hashScore <= alpha)) {
+            // the line we expect to be played ends here, so at least give it the stored move (which keeps a reply to ponder on)
+            if (entry.bestMove.data != 0) {
+                worker.pvLines[ply][0] = entry.bestMove;
+                worker.pvLengths[ply] = 1;
+            }
+            return hashScore;
         }
     }
-    const EvalScore evalScore = evaluator->computeEval(curr, Player(6-player));
+    const Player sideToMove = curr.getCurrentPlayer();
+    const EvalScore evalScore = evaluate(worker, curr);
+    const int score = getAdjustedScore(evalScore.evaluation, sideToMove);
     if (evalScore.gameOver) {
-        const int adjustedScore = -getAdjustedScore(evalScore.evaluation, Player(6-player));
+        return mateDistanceScore(score, ply);
+    }
+    // a position searched with a full window is on the line we expect to be played, where nothing is pruned by guesswork
+    const bool pvNode = beta - alpha > 1;
+    const bool inCheck = curr.isInCheck();
 
-        if (adjustedScore == 0) {
+    // null-move pruning: if we are already doing so well that even skipping our turn keeps the score at or above beta,
+    // a real move almost surely would too, and a shallower search is enough to show it.
+    // It is not tried when we could be in zugzwang, where every move makes things worse and skipping would not be allowed:
+    // with only pawns left to move, and in pawnless endgames. The move before must not be a null move either.
+    if (nullMovePruning && pruneMode && !pvNode && !inCheck && depthRemaining >= 3 && previousMove.data != 0 && score >= beta
+            && curr.hasNonPawnMaterial(sideToMove) && !curr.isPawnless()) {
+        const int reduction = 2 + depthRemaining / 4;
+        const Undo undo = curr.makeNullMove();
+        const int nullValue = -negamax(worker, curr, depthRemaining - 1 - reduction, -beta, -beta + 1, ply + 1, PackedMove{});
+        curr.unmakeNullMove(undo);
+        if (isStopped(worker)) {
             return 0;
+        }
+        if (nullValue >= beta) {
+            // a checkmate found after skipping a turn is not a real one
+            return (nullValue >= mateThreshold) ? beta : nullValue;
+        }
+    }
 
-        // increase the score if we are close to checkmate (regardless of the player, put it towards their magnitude)
+    const int originalAlpha = alpha;
+    // the best move found by an earlier (shallower) search of this position is most likely to still be the best, so it is tried first
+    MovePicker picker{curr, hashHit ? entry.bestMove : PackedMove{}, worker.moveHistory, ply, previousMove};
+    // the quiet moves searched so far, which lose history score if a later move causes the cutoff
+    PackedMove quietsTried[256];
+    int quietCount = 0;
+    int bestScore = -infinity;
+    PackedMove bestMove{};
+    int moveCount = 0;
+    for (PackedMove move = picker.nextMove(); move.data != 0; move = picker.nextMove()) {
+        const Undo undo = curr.makeMove(move);
+        int currValue;
+        if (moveCount == 0 || !pruneMode) {
+            currValue = -negamax(worker, curr, depthRemaining - 1, -beta, -alpha, ply + 1, move);
         } else {
-            if (adjustedScore > 0) {
-                return adjustedScore + depthRemaining;
-            } else {
-                return adjustedScore - depthRemaining;
+            // late move reductions: quiet moves that the ordering put late are unlikely to be best, so they are first searched
+            // less deeply. Moves out of check, and moves that give check, are kept at full depth
+            int reduction = 0;
+            if (lateMoveReductions && depthRemaining >= 3 && moveCount >= lmrMoveCount && !inCheck && isQuiet(move) && !curr.isInCheck()) {
+                reduction = std::min((moveCount >= 2 * lmrMoveCount && depthRemaining >= 6) ? 2 : 1, depthRemaining - 2);
+            }
+            currValue = -negamax(worker, curr, depthRemaining - 1 - reduction, -alpha - 1, -alpha, ply + 1, move);
+            // a reduced move that looks better than expected is verified at full depth
+            if (reduction > 0 && currValue > alpha) {
+                currValue = -negamax(worker, curr, depthRemaining - 1, -alpha - 1, -alpha, ply + 1, move);
+            }
+            if (currValue > alpha && currValue < beta) {
+                currValue = -negamax(worker, curr, depthRemaining - 1, -beta, -alpha, ply + 1, move);
             }
         }
-    }
-    // base case: we get our adjusted board evaluation, but negate it since we are the min player
-    if (depthRemaining == 0) {
-        int rawScore = -evaluator->computeEval(curr, Player(6-player)).evaluation;
-        return getAdjustedScore(rawScore, Player(6-player));
-    }
-    std::vector<std::shared_ptr<BitBoard>> children = getMoves(curr);
-    int minMove = INT_MAX;
-    for (const auto& child : children) {
-        int currValue = maxPlayer(*child, depthRemaining - 1);
-        if (currValue < minMove) {
-            minMove = currValue;
+        curr.unmakeMove(move, undo);
+        ++moveCount;
+        if (isStopped(worker)) {
+            return 0;
+        }
+        if (currValue > bestScore) {
+            bestScore = currValue;
+            bestMove = move;
+        }
+        if (currValue > alpha) {
+            alpha = currValue;
+            worker.updatePrincipalVariation(ply, move);
         }
 
-        // stop searching if the other player can already put you in a worse spot than what you already have
-        if (pruneMode && currValue < alphaMax.top()) {
+        // stop searching if the other player already has a better option earlier in the tree than letting us get here
+        if (pruneMode && alpha >= beta) {
+            if (isQuiet(move)) {
+                worker.moveHistory.updateQuiet(sideToMove == Player::White ? 0 : 1, ply, depthRemaining, move, previousMove, quietsTried, quietCount);
+            }
             break;
         }
+        if (isQuiet(move)) {
+            quietsTried[quietCount++] = move;
+        }
     }
-    hash.setKeyValue(options[options.size() - 1], minMove, false);
-    return minMove;
+
+    // a score at or below the original alpha only tells us that no move did better (an upper bound), and a score
+    // at or above beta only tells us that some move was good enough to stop searching (a lower bound)
+    Bound bound = Bound::Exact;
+    if (bestScore <= originalAlpha) {
+        bound = Bound::Upper;
+    } else if (bestScore >= beta) {
+        bound = Bound::Lower;
+    }
+    hash.store(curr.getHashKey(), scoreToHash(bestScore, ply), depthRemaining, bound, bestMove);
+    return bestScore;
 }
 
-std::vector<std::shared_ptr<BitBoard>> Computer::getMoves(const BitBoard& board) const
+int Computer::quiescence(SearchWorker& worker, BitBoard& curr, int alpha, const int beta, const int ply)
 {
-    return board.generateValidNextPositions();
+    checkTime(worker);
+    if (isStopped(worker)) {
+        return 0;
+    }
+
+    const EvalScore evalScore = evaluate(worker, curr);
+    const int standPat = getAdjustedScore(evalScore.evaluation, curr.getCurrentPlayer());
+    if (evalScore.gameOver) {
+        return mateDistanceScore(standPat, ply);
+    }
+    if (ply >= MoveHistory::maxPly) {
+        return standPat;
+    }
+
+    // when not in check we do not have to capture anything, so the evaluation is already a lower bound on the score ("standing pat").
+    // in check every way out is searched instead, since standing still is not an option
+    const bool inCheck = curr.isInCheck();
+    int bestScore = -infinity;
+    if (!inCheck) {
+        bestScore = standPat;
+        if (bestScore >= beta) {
+            return bestScore;
+        }
+        if (bestScore > alpha) {
+            alpha = bestScore;
+        }
+    }
+
+    MovePicker picker{curr, PackedMove{}, worker.moveHistory, ply, PackedMove{}, true};
+    for (PackedMove move = picker.nextMove(); move.data != 0; move = picker.nextMove()) {
+        // a capture that loses material in the exchange on its tile is very unlikely to be better than standing pat, and every
+        // capture after it loses material too
+        if (!inCheck && picker.isBadCapture()) {
+            break;
+        }
+        // delta pruning: skip a capture that could not raise alpha even if it won its victim for free (with some margin for
+        // what the evaluation misses). Promotions can change the score by too much to be skipped this way
+        if (!inCheck && !move.isPromotion()) {
+            const int victim = move.isEnPassant() ? Piece::P : curr.getPiece(move.getEnd()) % 6;
+            if (standPat + MovePicker::pieceValues[victim] + deltaMargin <= alpha) {
+                continue;
+            }
+        }
+
+        const Undo undo = curr.makeMove(move);
+        const int currValue = -quiescence(worker, curr, -beta, -alpha, ply + 1);
+        curr.unmakeMove(move, undo);
+        if (isStopped(worker)) {
+            return 0;
+        }
+        if (currValue > bestScore) {
+            bestScore = currValue;
+            if (bestScore > alpha) {
+                alpha = bestScore;
+            }
+        }
+        if (pruneMode && alpha >= beta) {
+            break;
+        }
+    }
+    return bestScore;
 }
@@ -6,30 +6,128 @@
 #include "./Evaluation/Evaluator.h"
 #include "Player.h"
 #include "Hash.h"
+#include "EvalCache.h"
+#include "SearchLimits.h"
+#include "SearchInfo.h"
+#include "MovePicker.h"
 #include <vector>
-#include <stack>
+#include <chrono>
+#include <atomic>
+#include <functional>
 
 class Computer {
+    /*
+        Level 4 searches with several threads at once ("Lazy SMP"). Every thread searches the same position, and they only
+        work together through the transposition table: what one thread stores lets the others skip or better order that part
+        of the tree. Helper threads start their iterations at staggered depths so that they tend to be ahead of the main
+        thread, filling in the table for it. The main thread manages the time and its result is the move we play.
+    */
+    // the state that each search thread keeps to itself
+    struct SearchWorker {
+        // Stores the evaluator used for numerically evaluating board states (decorated based on the level).
+        // evaluators are not made to be shared between threads, so each thread has its own
+        std::unique_ptr<Evaluator> evaluator;
+        // the number of positions this thread visited in the current search, also used to only check the clock every so often.
+        // only its own thread writes it, but it is atomic so that it can be read while the search runs
+        std::atomic<U64> nodes = 0;
+        // only the main thread checks the clock and decides when to stop
+        bool isMain = false;
+        // if this thread has finished an iteration of the current search, and so has a searched move to play
+        bool hasSearchedMove = false;
+        // the killer, counter-move and history tables this thread orders its moves with
+        MoveHistory moveHistory;
+        // the best line of play found so far from each ply of the position being searched: `pvLines[ply]` holds
+        // `pvLengths[ply]` moves, starting with the best move at `ply` and followed by the best line after it
+        PackedMove pvLines[MoveHistory::maxPly + 1][MoveHistory::maxPly + 1];
+        int pvLengths[MoveHistory::maxPly + 1];
+
+        // sets the line at `ply` to `move` followed by the line found after it at `ply + 1`
+        void updatePrincipalVariation(const int ply, const PackedMove move);
+    };
+
     // do not change the order of member variables
     // Stores the player that this computer is
     const Player player;
     // Stores the level (1-4) that this computer will play at
     const int level;
-    // Stores the evaluator used for numerically evaluating board states (decorated based on the level)
-    const std::unique_ptr<Evaluator> evaluator;
+    // the state of each search thread; the first is the main thread, which is also used for levels 1-3
+    std::vector<SearchWorker> workers;
 
-    // stores the depth of our search tree for the minimax algorithm for determining the best move
+    // stores the depth of our search tree for the minimax algorithm for determining the best move, when no search limits are given
     const int searchDepth = 4;
+    // the deepest iteration we will ever search to when thinking for a set amount of time
+    static const int maxSearchDepth = 64;
     // a feature flag for turning alpha beta pruning (search optimization) on or off
     const bool pruneMode = true;
-    // used for keeping track of the best option for the max player stacked for every level so the min player does not do unnecessary searching
-    std::stack<int> alphaMax;
+    // feature flags for the pruning that can skip good moves (see `negamax`), so that they can be compared. Both need `pruneMode`
+    bool nullMovePruning = true;
+    bool lateMoveReductions = true;
+    // the number of moves searched at full depth before late move reductions start
+    static const int lmrMoveCount = 3;
+    // a score bound that no evaluation can reach, used as the initial alpha-beta window
+    static const int infinity = 1000000000;
+    // the evaluation of a checkmate (see GameOver). The search scores a checkmate `ply` moves from the root as
+    // `mateScore - ply` for the winner, so that a quicker checkmate always scores higher
+    static const int mateScore = 10000000;
+    // every score at least this far from 0 is a checkmate within the deepest ply the search can reach
+    static const int mateThreshold = mateScore - MoveHistory::maxPly;
+    // how far on either side of the last iteration's score the next iteration first searches (see `iterativeDeepening`)
+    static const int aspirationWindow = 25;
+    // how much a capture may gain beyond the value of its victim (such as from positional changes) before the quiescence
+    // search decides it can not be worth searching
+    static const int deltaMargin = 200;
 
-    // an instance of our hash class for storing computed evaluations
+    // our transposition table for storing computed evaluations. It is kept for the whole game.
     Hash hash;
+    // the static evaluations of positions the search has already evaluated, shared by every thread and kept for the whole game
+    EvalCache evalCache;
 
-    // method to obtain all hash keys for depths greater than equal to a given depth (these are considered as good evaluations at a given board depth)
-    std::vector<U64> candidateHashs(const BitBoard& curr, const int depth) const;
+    // the time management for the current search. We do not start a new iteration of the search after the soft deadline,
+    // and we abandon the search as soon as possible after the hard deadline.
+    bool timeLimited = false;
+    std::chrono::steady_clock::time_point softDeadline;
+    std::chrono::steady_clock::time_point hardDeadline;
+    std::chrono::steady_clock::time_point searchStart;
+    // the number of positions the main thread may search, or 0 for no limit
+    U64 nodeLimit = 0;
+    // if the search should keep going until told to stop, even after finding a checkmate
+    bool infiniteSearch = false;
+    // the line of play that the main thread's last finished iteration expects, starting with the move it would play
+    std::vector<PackedMove> principalVariation;
+    // the limits of the current search, kept so that a ponder search can start its clock once it becomes the real one
+    SearchLimits searchLimits;
+    // set while the search thinks on the opponent's time, during which the deadlines are not checked
+    std::atomic<bool> pondering = false;
+    // set once the search should end, telling every level of every thread's search to return right away
+    std::atomic<bool> stopped = false;
+
+    // called with the progress of the search after each depth is finished, if set
+    std::function<void(const SearchInfo&)> infoCallback;
+    // reports the progress after the main thread finishes an iteration
+    void reportIteration(const int depth, const int score);
+
+    // resets the state of the search and sets the deadlines based on the limits (unless pondering)
+    void startClock(const SearchLimits& limits);
+    // sets the deadlines for a search with `searchLimits` that starts now
+    void setDeadlines();
+    // returns if the search has a time limit and the given deadline has passed
+    bool isPastDeadline(const std::chrono::steady_clock::time_point& deadline) const;
+    // returns if `worker` should end its search now. The main thread always finishes its first iteration, however soon it is
+    // stopped, so that the move it plays has been searched (the first iteration is very quick)
+    bool isStopped(const SearchWorker& worker) const;
+    // counts a visited position, and has the main thread check the clock every so often, setting `stopped` once the hard deadline
+    // (or the node limit) has passed
+    void checkTime(SearchWorker& worker);
+    // moves `move` to the front of `moves` (if it is in it), so that it is searched first
+    static void moveToFront(MoveList& moves, const PackedMove move);
+    // returns if a move does not capture or promote, which is the kind of move the killer and history tables are about
+    static bool isQuiet(const PackedMove move);
+    // given the score of a finished game for the player to move, this returns the score of reaching it `ply` moves from the root
+    static int mateDistanceScore(const int score, const int ply);
+    // the transposition table stores a checkmate's score by its distance from the stored position rather than from the root
+    // (which differs each time the position is reached), so scores are converted when stored at, and probed from, `ply`
+    static int scoreToHash(const int score, const int ply);
+    static int scoreFromHash(const int score, const int ply);
 
     // given an evaluation in terms of the white player, this returns the corresponding evaluation for the given player (negated iff black)
     int getAdjustedScore(const int score, const Player player) const;
@@ -38,25 +136,71 @@ class Computer {
         The below methods all relate to our implementation of the minimax algorithm for determining the best move.
         There idea is that we evaluate a state based on what the other player can do assuming they make the best
         worst move for you (the move that puts you in the worst position and them in the best). This is recursively defined
-        with depth searchDepth. Once we hit the end of our depth, we define the evaluatio of a board as positive what our evaluator
-        returns for the computer player and negative for the opponent player.
+        with depth searchDepth. We use the negamax form of minimax: every score is from the point of view of the player
+        whose turn it is, so the score of a position is the negation of the best score its opponent can get after any move.
     */
+    // returns the static evaluation of `board` by the worker's evaluator, in terms of the white player, using `evalCache`
+    // when it already has the position
+    EvalScore evaluate(SearchWorker& worker, const BitBoard& board);
     // returns the board evaluation without considering min/max player or depth (just for level 1-3 where we do not look ahead beyond one move)
     int basicEvalScore(const BitBoard& board) const;
-    // returns the max evaluation move for the max player (the computer player) based on recursive calls to the min player or a base case that gets the +ve board evaluation
-    int maxPlayer(const BitBoard& curr, int depthRemaining);
-    // returns the min evaluation move for the min player (the other player) based on recursive calls to 
-    int minPlayer(const BitBoard& curr, int depthRemaining);
-    // returns the possible next moves for a given board and depth (the depth determines whose turn it is which determines the moves)
-    std::vector<std::shared_ptr<BitBoard>> getMoves(const BitBoard& board) const;
+    // runs iterations of the search at depths `startDepth` to `maxDepth` of the moves from `board` until we are stopped, returning the best move.
+    // `rootMoves` should have the move to search first at the front.
+    // Each iteration first searches a narrow window around the last one's score (an "aspiration window"), which prunes far more,
+    // and only widens it when the score falls outside it.
+    PackedMove iterativeDeepening(SearchWorker& worker, const BitBoard& board, MoveList rootMoves, const int startDepth, const int maxDepth);
+    // searches each of `rootMoves` from `board` to `depth` inside the (alpha, beta) window, returning the best score like `negamax`.
+    // `bestMove` is set to the best move if any move scored above alpha, and is left alone otherwise
+    int searchRoot(SearchWorker& worker, BitBoard& board, const MoveList& rootMoves, const int depth, int alpha, const int beta, PackedMove& bestMove);
+    // returns the score of `curr` for the player whose turn it is, searching `depthRemaining` moves ahead.
+    // Only scores inside the (alpha, beta) window matter: if the true score is at most alpha, some score <= alpha is returned,
+    // and if it is at least beta, some score >= beta is returned (fail-soft), which lets whole subtrees be skipped.
+    // `curr` is searched in place: moves are made and unmade on it, so it is unchanged when this returns.
+    // `ply` is how many moves `curr` is from the root, and `previousMove` the move that led to it, which are used to order moves.
+    // This is a principal variation search: only the first move gets the full window, and the rest are first searched with an
+    // empty one (alpha, alpha + 1), which only proves whether they are worse. A move is searched again with the full window
+    // only if it turns out better. Null-move pruning and late move reductions search some positions less deeply than asked.
+    int negamax(SearchWorker& worker, BitBoard& curr, int depthRemaining, int alpha, const int beta, const int ply, const PackedMove previousMove);
+    // the quiescence search, which `negamax` calls once it runs out of depth. Stopping the search in the middle of an exchange
+    // would score a position as if the last capture could not be answered, so this keeps searching only captures and promotions
+    // (and every way out of check) until the position is quiet. Returns the score like `negamax`.
+    int quiescence(SearchWorker& worker, BitBoard& curr, int alpha, const int beta, const int ply);
 
     // sets the evaluator based on the level
     std::unique_ptr<Evaluator> setEvaluator() const;
 public:
-    Computer(Player player, int level);
+    Computer(Player player, int level, int hashSizeMB = Hash::defaultSizeMB, int threads = 1);
     Computer(const Computer& other);
-    // returns the best move as the new BitBoard after the move based on the current board
-    std::shared_ptr<BitBoard> findMove(const BitBoard& board);
+    // returns the best move as the new BitBoard after the move based on the current board.
+    // level 4 searches deeper and deeper until it runs out of the time (or depth) allowed by `limits`, after which the line of play
+    // it expects is given by `getPrincipalVariation`
+    std::shared_ptr<BitBoard> findMove(const BitBoard& board, const SearchLimits& limits = SearchLimits{});
+    // like `findMove`, but returns the move itself. Returns an empty move (0) if there are no legal moves.
+    PackedMove findBestMove(const BitBoard& board, const SearchLimits& limits = SearchLimits{});
+    // `findBestMove` split into its two steps, so that a search can be started by one thread and run by another.
+    // `beginSearch` resets the stop flag and starts the clock; calling `stop` any time after it ends the search run by `runSearch`
+    void beginSearch(const SearchLimits& limits);
+    PackedMove runSearch(const BitBoard& board, const SearchLimits& limits);
+    // returns the line of play that the last search expects, starting with the move it chose (and empty for levels 1-3)
+    std::vector<PackedMove> getPrincipalVariation() const;
+    // returns the reply to `move` that the last search expects, or an empty move if it does not know one
+    PackedMove getPonderMove(const PackedMove move) const;
+
+    // tells a search running on another thread to finish as soon as possible. It still returns the best move it has found.
+    void stop();
+    // turns a ponder search (see `SearchLimits::ponder`) into a normal one, starting its time limits from now.
+    // the search keeps everything it has found so far
+    void ponderHit();
+    // turn null-move pruning and late move reductions on or off (both are on by default).
+    // they should only be changed while no search is running
+    void setNullMovePruning(const bool enabled);
+    void setLateMoveReductions(const bool enabled);
+    // sets a function to be called (on the searching thread) with the progress of each level 4 search after each depth
+    void setInfoCallback(std::function<void(const SearchInfo&)> callback);
+    // returns the number of positions all threads visited in the current (or last) search
+    U64 getNodes() const;
+    // empties the transposition table and the move ordering tables, forgetting everything from earlier searches
+    void clearHash();
 };
 
 #endif
@@ -21,7 +21,7 @@ void DisplayObserver::notify()
     } else if (state.blackHasWin) {
         showWin(Player::Black);
     } else if (state.hasDraw) {
-        if (gameBoard->generateValidNextPositions().size() == 0) {
+        if (!gameBoard->hasAnyLegalMove()) {
             showStalemate();
         } else {
             showDraw();
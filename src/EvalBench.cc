@@ -0,0 +1,117 @@
+#include "EvalBench.h"
+#include "./Evaluation/LevelEvaluators.h"
+#include <chrono>
+#include <cstdlib>
+
+const std::vector<std::pair<std::string, int>> EvalBench::startingPositions = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 3},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 2},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 2},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 3},
+};
+
+void EvalBench::collectPositions(BitBoard& board, const int depth, std::vector<BitBoard>& positions)
+{
+    positions.push_back(board);
+    if (depth == 0) {
+        return;
+    }
+    MoveList moves;
+    board.generateMoves(moves);
+    for (const auto move : moves) {
+        const Undo undo = board.makeMove(move);
+        collectPositions(board, depth - 1, positions);
+        board.unmakeMove(move, undo);
+    }
+}
+
+std::unique_ptr<Evaluator> EvalBench::makeDecoratorChain()
+{
+    return std::make_unique<GameOver>(
+        std::make_unique<EarlyGameKingPosition>(
+            std::make_unique<ActiveKnights>(
+                std::make_unique<BishopPressure>(
+                    std::make_unique<ConnectedRooks>(
+                        std::make_unique<PawnlessEndgame>(
+                            std::make_unique<PawnRelations>(
+                                std::make_unique<PushPawnsLateGame>(
+                                    std::make_unique<QueenPressure>(
+                                        std::make_unique<RookPressure>(
+                                            std::make_unique<Level4Base>()
+                                        )
+                                    )
+                                )
+                            )
+                        )
+                    )
+                )
+            )
+        )
+    );
+}
+
+double EvalBench::timeEvaluator(Evaluator& evaluator, const std::vector<BitBoard>& positions, const int rounds, std::vector<int>& scores)
+{
+    using namespace std::chrono;
+    scores.assign(positions.size(), 0);
+    const auto start = steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (size_t i = 0; i < positions.size(); ++i) {
+            scores[i] = evaluator.computeEval(positions[i], Player::White).evaluation;
+        }
+    }
+    return duration<double>(steady_clock::now() - start).count();
+}
+
+int EvalBench::runCommand(const std::vector<std::string>& args, std::ostream& out)
+{
+    int rounds = 10;
+    try {
+        if (!args.empty()) {
+            rounds = std::max(1, std::stoi(args[0]));
+        }
+    } catch (const std::exception&) {
+        out << "usage: chess evalbench [rounds]" << std::endl;
+        return 1;
+    }
+
+    std::vector<BitBoard> positions;
+    for (const auto& [fen, depth] : startingPositions) {
+        BitBoard board = *BitBoard::fromFEN(fen);
+        collectPositions(board, depth, positions);
+    }
+    out << positions.size() << " positions, evaluated " << rounds << " times each" << std::endl;
+
+    auto chain = makeDecoratorChain();
+    Level4Evaluator pipeline;
+
+    // the positions are in the order a search would reach them, so a first pass over them with an empty pawn hash shows
+    // how often a search finds its pawns already in it
+    PawnHash& pawnHash = PawnHash::forThisThread();
+    pawnHash.clear();
+    for (const auto& position : positions) {
+        pipeline.computeEval(position, Player::White);
+    }
+    out << "  pawn hash hit rate: " << pawnHash.getHitRate() * 100 << "% of " << pawnHash.getProbes() << " positions" << std::endl;
+
+    std::vector<int> chainScores, pipelineScores;
+    const double chainSeconds = timeEvaluator(*chain, positions, rounds, chainScores);
+    const double pipelineSeconds = timeEvaluator(pipeline, positions, rounds, pipelineScores);
+
+    const double evaluations = static_cast<double>(positions.size()) * rounds;
+    out << "  decorator chain: " << static_cast<int>(chainSeconds * 1000) << " ms ("
+        << static_cast<U64>(evaluations / chainSeconds) << " evaluations/s)" << std::endl;
+    out << "  EvalPipeline:    " << static_cast<int>(pipelineSeconds * 1000) << " ms ("
+        << static_cast<U64>(evaluations / pipelineSeconds) << " evaluations/s)" << std::endl;
+    out << "  speedup: " << chainSeconds / pipelineSeconds << "x" << std::endl;
+
+    // Level4Base adds up to 5 at random, so the two only have to agree to within that
+    for (size_t i = 0; i < positions.size(); ++i) {
+        if (std::abs(chainScores[i] - pipelineScores[i]) > 5) {
+            out << "MISMATCH on " << positions[i].toFEN() << ": the chain gave " << chainScores[i]
+                << " and the pipeline gave " << pipelineScores[i] << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,34 @@
+#ifndef EVALBENCH_H
+#define EVALBENCH_H
+
+#include "BitBoard.h"
+#include "./Evaluation/Evaluator.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+
+/*
+ * Measures how many positions per second computer4's evaluation gets through, comparing `Level4Evaluator` (see
+ * Evaluation/LevelEvaluators.h) against the same terms put together as a chain of decorators at runtime.
+ * The positions are every position a few moves from some typical ones, like the leaves of a search.
+ * It also reports how often the pawn hash (see Evaluation/PawnHash.h) already has the pawns of a position.
+ * It is run with `./chess evalbench [rounds]`.
+ */
+class EvalBench {
+    // the positions to evaluate, and how many moves from them to collect positions
+    static const std::vector<std::pair<std::string, int>> startingPositions;
+
+    // adds `board` and every position up to `depth` moves from it to `positions`
+    static void collectPositions(BitBoard& board, const int depth, std::vector<BitBoard>& positions);
+    // returns computer4's evaluator as a chain of decorators, each calling the next through a virtual call
+    static std::unique_ptr<Evaluator> makeDecoratorChain();
+    // evaluates every position `rounds` times, returning the seconds taken. `scores` gets the evaluation of each position
+    static double timeEvaluator(Evaluator& evaluator, const std::vector<BitBoard>& positions, const int rounds, std::vector<int>& scores);
+public:
+    // runs the benchmark, returning the program's exit code, which is 1 if the two evaluators disagree on some position.
+    // `args` may give the number of times to evaluate every position
+    static int runCommand(const std::vector<std::string>& args, std::ostream& out);
+};
+
+#endif
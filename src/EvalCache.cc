@@ -0,0 +1,51 @@
+#include "EvalCache.h"
+#include <bit>
+#include <algorithm>
+
+EvalCache::EvalCache(const int megabytes)
+{
+    // round the number of entries down to a power of two, so that a key can be mapped to an entry with a mask
+    const U64 entryCount = std::bit_floor((static_cast<U64>(std::max(megabytes, 1)) << 20) / sizeof(Entry));
+    std::vector<Entry>(entryCount).swap(table);
+    entryMask = entryCount - 1;
+}
+
+void EvalCache::clear()
+{
+    for (auto& entry : table) {
+        entry.keyXorData.store(0, std::memory_order_relaxed);
+        entry.data.store(0, std::memory_order_relaxed);
+    }
+}
+
+U64 EvalCache::packData(const EvalScore& score)
+{
+    return static_cast<U64>(static_cast<uint32_t>(score.evaluation))
+        | (static_cast<U64>(score.gameOver) << 32)
+        | (1ull << 33);
+}
+
+EvalScore EvalCache::unpackData(const U64 data)
+{
+    return EvalScore{static_cast<int32_t>(static_cast<uint32_t>(data)), static_cast<bool>((data >> 32) & 1)};
+}
+
+bool EvalCache::probe(const U64 key, EvalScore& score) const
+{
+    const Entry& entry = table[key & entryMask];
+    const U64 data = entry.data.load(std::memory_order_relaxed);
+    const U64 keyXorData = entry.keyXorData.load(std::memory_order_relaxed);
+    if ((keyXorData ^ data) == key && data != 0) {
+        score = unpackData(data);
+        return true;
+    }
+    return false;
+}
+
+void EvalCache::store(const U64 key, const EvalScore& score)
+{
+    Entry& entry = table[key & entryMask];
+    const U64 data = packData(score);
+    entry.data.store(data, std::memory_order_relaxed);
+    entry.keyXorData.store(key ^ data, std::memory_order_relaxed);
+}
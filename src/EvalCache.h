@@ -0,0 +1,45 @@
+#ifndef EVALCACHE_H
+#define EVALCACHE_H
+
+#include "BitBoard.h"
+#include "./Evaluation/EvalScore.h"
+#include <atomic>
+#include <vector>
+
+/*
+ * A fixed-size table of static evaluations, looked up by a position's Zobrist key, so that a position reached again
+ * (through a transposition, a re-search, or a later iteration) is not evaluated again. The evaluations are stored in terms
+ * of the white player, so they do not depend on whose turn it is or where in the tree the position was found.
+ *
+ * Each slot holds a single evaluation, and a newer one always replaces it. Like `Hash`, a slot is two 64-bit words: the
+ * packed evaluation, and the key XOR-ed with it, so a slot torn by two threads writing it at once reads as a miss.
+ * This lets every search thread share the table without any locks.
+ */
+class EvalCache {
+    struct Entry {
+        std::atomic<U64> keyXorData{0};
+        std::atomic<U64> data{0};
+    };
+
+    std::vector<Entry> table;
+    // the number of entries minus one, used to turn a key into an entry index
+    U64 entryMask = 0;
+
+    // data is packed as: bits 0-31 evaluation, bit 32 game over, and bit 33 always set, so that an empty entry never matches
+    static U64 packData(const EvalScore& score);
+    static EvalScore unpackData(const U64 data);
+public:
+    static const int defaultSizeMB = 8;
+
+    // creates a table using (at most) the given number of megabytes
+    explicit EvalCache(const int megabytes = defaultSizeMB);
+
+    // removes every entry from the table
+    void clear();
+    // looks up a position by its Zobrist key, returning true and filling `score` iff it is in the table
+    bool probe(const U64 key, EvalScore& score) const;
+    // stores the static evaluation of a position
+    void store(const U64 key, const EvalScore& score);
+};
+
+#endif
@@ -4,9 +4,5 @@ ActiveKnights::ActiveKnights(std::unique_ptr<Evaluator> next): Decorator{std::mo
 
 EvalScore ActiveKnights::computeEval(const BitBoard& board, Player botPlayer)
 {
-    int score = next->computeEval(board, botPlayer).evaluation;
-    
-    score += board.activeKnights(Player::White);
-    score += -1 * board.activeKnights(Player::Black);
-    return EvalScore{score, false};
+    return evaluate(board, botPlayer, [this, &board, botPlayer]() { return next->computeEval(board, botPlayer); });
 }
@@ -7,6 +7,18 @@ class ActiveKnights : public Decorator {
 public:
     ActiveKnights(std::unique_ptr<Evaluator> next);
     EvalScore computeEval(const BitBoard& board, const Player botPlayer) override;
+    template <typename Next>
+    static EvalScore evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext);
 };
 
+template <typename Next>
+EvalScore ActiveKnights::evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext)
+{
+    int score = evaluateNext().evaluation;
+    
+    score += board.activeKnights(Player::White);
+    score += -1 * board.activeKnights(Player::Black);
+    return EvalScore{score, false};
+}
+
 #endif
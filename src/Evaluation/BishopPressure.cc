@@ -4,9 +4,5 @@ BishopPressure::BishopPressure(std::unique_ptr<Evaluator> next): Decorator{std::
 
 EvalScore BishopPressure::computeEval(const BitBoard& board, Player botPlayer)
 {
-    int score = next->computeEval(board, botPlayer).evaluation;
-    
-    score += board.bishopPressureBonus(Player::White);
-    score += -1 * board.bishopPressureBonus(Player::Black);
-    return EvalScore{score, false};
+    return evaluate(board, botPlayer, [this, &board, botPlayer]() { return next->computeEval(board, botPlayer); });
 }
@@ -1,5 +1,5 @@
 #ifndef BISHOPPRESSURE_H
-#define BISHIPPRESSURE_H
+#define BISHOPPRESSURE_H
 
 #include "Decorator.h"
 
@@ -7,6 +7,18 @@ class BishopPressure : public Decorator {
 public:
     BishopPressure(std::unique_ptr<Evaluator> next);
     EvalScore computeEval(const BitBoard& board, const Player botPlayer) override;
+    template <typename Next>
+    static EvalScore evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext);
 };
 
+template <typename Next>
+EvalScore BishopPressure::evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext)
+{
+    int score = evaluateNext().evaluation;
+    
+    score += board.bishopPressureBonus(Player::White);
+    score += -1 * board.bishopPressureBonus(Player::Black);
+    return EvalScore{score, false};
+}
+
 #endif
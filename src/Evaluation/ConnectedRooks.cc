@@ -4,9 +4,5 @@ ConnectedRooks::ConnectedRooks(std::unique_ptr<Evaluator> next): Decorator{std::
 
 EvalScore ConnectedRooks::computeEval(const BitBoard& board, Player botPlayer)
 {
-    int score = next->computeEval(board, botPlayer).evaluation;
-    
-    score += board.connectedRooksBonus(Player::White);
-    score += -1 * board.connectedRooksBonus(Player::Black);
-    return EvalScore{score, false};
+    return evaluate(board, botPlayer, [this, &board, botPlayer]() { return next->computeEval(board, botPlayer); });
 }
@@ -7,6 +7,18 @@ class ConnectedRooks : public Decorator {
 public:
     ConnectedRooks(std::unique_ptr<Evaluator> next);
     EvalScore computeEval(const BitBoard& board, const Player botPlayer) override;
+    template <typename Next>
+    static EvalScore evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext);
 };
 
+template <typename Next>
+EvalScore ConnectedRooks::evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext)
+{
+    int score = evaluateNext().evaluation;
+    
+    score += board.connectedRooksBonus(Player::White);
+    score += -1 * board.connectedRooksBonus(Player::Black);
+    return EvalScore{score, false};
+}
+
 #endif
@@ -5,6 +5,13 @@
 #include "EvalScore.h"
 #include <memory>
 
+/*
+ * An evaluator that adds its own terms to the evaluation of the evaluator it wraps (`next`).
+ * Every decorator also has a static `evaluate(board, botPlayer, evaluateNext)`, a template on the type of `evaluateNext`,
+ * which gives its evaluation where `evaluateNext()` gives the evaluation of what it decorates. Its `computeEval` calls
+ * `evaluate` with `next->computeEval`, and `EvalPipeline` calls it with the next stage of the pipeline, so both give the same
+ * evaluation. The evaluators at the end of a chain (Level1, Level2 and Level4Base) have a static `evaluate(board, botPlayer)`.
+ */
 class Decorator : public Evaluator {
 protected:
     std::unique_ptr<Evaluator> next;
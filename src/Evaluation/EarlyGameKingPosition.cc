@@ -4,9 +4,5 @@ EarlyGameKingPosition::EarlyGameKingPosition(std::unique_ptr<Evaluator> next): D
 
 EvalScore EarlyGameKingPosition::computeEval(const BitBoard& board, Player botPlayer)
 {
-    int score = next->computeEval(board, botPlayer).evaluation;
-    
-    score += board.kingPositionEarlyGame(Player::White);
-    score += -1 * board.kingPositionEarlyGame(Player::Black);
-    return EvalScore{score, false};
+    return evaluate(board, botPlayer, [this, &board, botPlayer]() { return next->computeEval(board, botPlayer); });
 }
@@ -7,6 +7,18 @@ class EarlyGameKingPosition : public Decorator {
 public:
     EarlyGameKingPosition(std::unique_ptr<Evaluator> next);
     EvalScore computeEval(const BitBoard& board, const Player botPlayer) override;
+    template <typename Next>
+    static EvalScore evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext);
 };
 
+template <typename Next>
+EvalScore EarlyGameKingPosition::evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext)
+{
+    int score = evaluateNext().evaluation;
+    
+    score += board.kingPositionEarlyGame(Player::White);
+    score += -1 * board.kingPositionEarlyGame(Player::Black);
+    return EvalScore{score, false};
+}
+
 #endif
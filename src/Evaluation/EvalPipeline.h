@@ -0,0 +1,31 @@
+#ifndef EVALPIPELINE_H
+#define EVALPIPELINE_H
+
+#include "Evaluator.h"
+
+/*
+ * An evaluator whose stages are chosen at compile time. `EvalPipeline<GameOver, EarlyGameKingPosition, ..., Level4Base>`
+ * evaluates the same way as the chain of decorators `GameOver(EarlyGameKingPosition(...(Level4Base)))`, by calling the static
+ * `evaluate` of each stage (see Decorator.h) with the evaluation of the stages after it.
+ * The chain makes a virtual call for every decorator, while here every stage is known to the compiler, so the only virtual call
+ * is to `computeEval`, and the stages can be inlined into it as one function.
+ */
+template <typename... Stages>
+class EvalPipeline : public Evaluator {
+    template <typename Stage, typename... Rest>
+    static EvalScore evaluate(const BitBoard& board, const Player botPlayer)
+    {
+        if constexpr (sizeof...(Rest) == 0) {
+            return Stage::evaluate(board, botPlayer);
+        } else {
+            return Stage::evaluate(board, botPlayer, [&board, botPlayer]() { return evaluate<Rest...>(board, botPlayer); });
+        }
+    }
+public:
+    EvalScore computeEval(const BitBoard& board, const Player botPlayer) override
+    {
+        return evaluate<Stages...>(board, botPlayer);
+    }
+};
+
+#endif
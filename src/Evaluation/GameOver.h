@@ -8,6 +8,29 @@ class GameOver : public Decorator {
 public:
     GameOver(std::unique_ptr<Evaluator>next);
     EvalScore computeEval(const BitBoard& board, const Player botPlayer) override;
+    template <typename Next>
+    static EvalScore evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext);
 };
 
+template <typename Next>
+EvalScore GameOver::evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext)
+{
+    const BoardStateSimplified state = board.getStateSimplified();
+    int score = 0;
+    
+    // give a very high, or exactly 0 eval, if the game is over.
+    if (state.whiteHasWin || state.hasDraw || state.blackHasWin) {
+        if (state.whiteHasWin) {
+            score = 10000000; // 10M
+        } else if (state.blackHasWin) {
+            score = -10000000; // -10M
+        }
+        return EvalScore{score, true};
+    } else {
+        score = evaluateNext().evaluation;
+        return EvalScore{score, false};
+    }
+
+}
+
 #endif
@@ -2,10 +2,18 @@
 #define LEVEL1_H
 
 #include "Evaluator.h"
+#include <cstdlib>
 
 class Level1 : public Evaluator {
 public:
     EvalScore computeEval(const BitBoard& board, const Player botPlayer) override;
+    static EvalScore evaluate(const BitBoard& board, const Player botPlayer);
 };
 
+inline EvalScore Level1::evaluate(const BitBoard& board, const Player botPlayer)
+{
+    const BoardStateSimplified state = board.getStateSimplified();
+    return EvalScore{rand() % 100, state.whiteHasWin || state.hasDraw || state.blackHasWin};
+}
+
 #endif
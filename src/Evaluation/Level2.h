@@ -2,10 +2,31 @@
 #define LEVEL2_H
 
 #include "Decorator.h"
+#include "../BoardState.h"
 
 class Level2 : public Evaluator {
 public:
     EvalScore computeEval(const BitBoard& board, const Player botPlayer) override;
+    static EvalScore evaluate(const BitBoard& board, const Player botPlayer);
 };
 
+inline EvalScore Level2::evaluate(const BitBoard& board, const Player botPlayer)
+{
+    const BoardState state = board.getState();
+    int score = 0;
+    
+    if (botPlayer == Player::White) {
+        score = -1 * board.getPieceScores(Player::Black);
+        if (state.blackInCheck) {
+            score += 300;
+        }
+    } else {
+        score = board.getPieceScores(Player::White);
+        if (state.whiteInCheck) {
+            score += 300;
+        }
+    }
+    return EvalScore{score, state.whiteHasWin || state.hasDraw || state.blackHasWin};
+}
+
 #endif
@@ -7,6 +7,22 @@ class Level3 : public Decorator {
 public:
     Level3(std::unique_ptr<Evaluator>next);
     EvalScore computeEval(const BitBoard& board, const Player botPlayer) override;
+    // only the material of `botPlayer` is counted, and it also decides if the game is over
+    template <typename Next>
+    static EvalScore evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext);
 };
 
+template <typename Next>
+EvalScore Level3::evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext)
+{
+    const BoardStateSimplified state = board.getStateSimplified();
+    int score = evaluateNext().evaluation;
+    if (botPlayer == Player::White) {
+        score += board.getPieceScores(Player::White);
+    } else {
+        score += -1 * board.getPieceScores(Player::Black);
+    }
+    return EvalScore{score, state.whiteHasWin || state.hasDraw || state.blackHasWin};
+}
+
 #endif
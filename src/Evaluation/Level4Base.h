@@ -2,10 +2,27 @@
 #define LEVEL4BASE_H
 
 #include "Decorator.h"
+#include <random>
 
 class Level4Base : public Evaluator {
 public:
     EvalScore computeEval(const BitBoard& board, const Player botPlayer) override;
+    static EvalScore evaluate(const BitBoard& board, const Player botPlayer);
 };
 
+inline EvalScore Level4Base::evaluate(const BitBoard& board, const Player botPlayer)
+{
+    int score = 0;
+
+    // calculate the scores from each player
+    score += board.getPieceScores(Player::White);
+    score += -1 * board.getPieceScores(Player::Black);
+
+    // add slight randomness for games to differ. Each search thread has its own generator, since `rand()` shares one between them all.
+    thread_local std::minstd_rand generator{std::random_device{}()};
+    score += generator()%6;
+
+    return EvalScore{score, false};
+}
+
 #endif
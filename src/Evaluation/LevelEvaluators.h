@@ -0,0 +1,28 @@
+#ifndef LEVELEVALUATORS_H
+#define LEVELEVALUATORS_H
+
+#include "EvalPipeline.h"
+#include "Level1.h"
+#include "Level2.h"
+#include "Level3.h"
+#include "GameOver.h"
+#include "ActiveKnights.h"
+#include "BishopPressure.h"
+#include "ConnectedRooks.h"
+#include "EarlyGameKingPosition.h"
+#include "PawnlessEndgame.h"
+#include "PawnRelations.h"
+#include "PushPawnsLateGame.h"
+#include "QueenPressure.h"
+#include "RookPressure.h"
+#include "Level4Base.h"
+
+// the evaluator of each computer level, put together at compile time (see EvalPipeline).
+// the outermost decorator comes first, and GameOver should be the outermost for Level 4
+using Level1Evaluator = EvalPipeline<Level1>;
+using Level2Evaluator = EvalPipeline<Level2>;
+using Level3Evaluator = EvalPipeline<Level3, Level2>;
+using Level4Evaluator = EvalPipeline<GameOver, EarlyGameKingPosition, ActiveKnights, BishopPressure, ConnectedRooks, PawnlessEndgame,
+                                     PawnRelations, PushPawnsLateGame, QueenPressure, RookPressure, Level4Base>;
+
+#endif
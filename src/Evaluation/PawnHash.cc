@@ -0,0 +1,52 @@
+#include "PawnHash.h"
+
+PawnHash::PawnHash() : table(entryCount) {}
+
+const PawnHash::Entry& PawnHash::probe(const BitBoard& board)
+{
+    const U64 key = board.getPawnKey();
+    Entry& entry = table[key & (entryCount - 1)];
+
+    if (board.getHashKey() != lastPositionKey) {
+        lastPositionKey = board.getHashKey();
+        ++probes;
+        hits += (entry.key == key);
+    }
+    if (entry.key == key) {
+        return entry;
+    }
+
+    entry.key = key;
+    entry.structures[0] = board.getPawnStructure(Player::White);
+    entry.structures[1] = board.getPawnStructure(Player::Black);
+    return entry;
+}
+
+double PawnHash::getHitRate() const
+{
+    return (probes > 0) ? static_cast<double>(hits) / probes : 0;
+}
+
+U64 PawnHash::getProbes() const
+{
+    return probes;
+}
+
+void PawnHash::resetStatistics()
+{
+    probes = 0;
+    hits = 0;
+}
+
+void PawnHash::clear()
+{
+    table.assign(entryCount, Entry{});
+    lastPositionKey = 0;
+    resetStatistics();
+}
+
+PawnHash& PawnHash::forThisThread()
+{
+    thread_local PawnHash pawnHash;
+    return pawnHash;
+}
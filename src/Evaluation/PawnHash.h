@@ -0,0 +1,51 @@
+#ifndef PAWNHASH_H
+#define PAWNHASH_H
+
+#include "../BitBoard.h"
+#include <vector>
+
+/*
+ * A small table of pawn structures, looked up by the pawn key of a position (see `BitBoard::getPawnKey`).
+ * The pawns change far less often than the other pieces, so most positions the search evaluates have the same pawns as
+ * one evaluated shortly before, and the pawn terms (see PawnRelations and PushPawnsLateGame) can reuse its structure.
+ * Each search thread has its own table (see `forThisThread`), so no locking is needed. A newer position always replaces
+ * the entry it maps to.
+ */
+class PawnHash {
+public:
+    struct Entry {
+        // the pawn key of the position this entry is for. An empty entry has key 0, which is also the key of a position
+        // without pawns, whose structures are all 0 as well
+        U64 key = 0;
+        // indexed by the player's offset / 6
+        BitBoard::PawnStructure structures[2];
+    };
+private:
+    static const int entryCount = 1 << 13;
+
+    std::vector<Entry> table;
+    // the number of positions looked up, and how many of them were in the table
+    U64 probes = 0;
+    U64 hits = 0;
+    // the hash key of the last position looked up. Every evaluation looks up its position once for each pawn term,
+    // so this keeps the statistics to one lookup per position
+    U64 lastPositionKey = 0;
+public:
+    PawnHash();
+
+    // returns the pawn structures of both players in `board`, computing and storing them if they are not in the table
+    const Entry& probe(const BitBoard& board);
+
+    // returns the fraction of positions looked up since the statistics were last reset whose pawns were in the table
+    double getHitRate() const;
+    // returns the number of positions looked up since the statistics were last reset
+    U64 getProbes() const;
+    void resetStatistics();
+    // empties the table and resets the statistics
+    void clear();
+
+    // returns the calling thread's table
+    static PawnHash& forThisThread();
+};
+
+#endif
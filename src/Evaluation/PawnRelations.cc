@@ -4,9 +4,5 @@ PawnRelations::PawnRelations(std::unique_ptr<Evaluator> next): Decorator{std::mo
 
 EvalScore PawnRelations::computeEval(const BitBoard& board, Player botPlayer)
 {
-    int score = next->computeEval(board, botPlayer).evaluation;
-    
-    score += board.connectedAndStackedPawnBonus(Player::White);
-    score += -1 * board.connectedAndStackedPawnBonus(Player::Black);
-    return EvalScore{score, false};
+    return evaluate(board, botPlayer, [this, &board, botPlayer]() { return next->computeEval(board, botPlayer); });
 }
@@ -2,11 +2,26 @@
 #define PAWNRELATIONS_H
 
 #include "Decorator.h"
+#include "PawnHash.h"
 
 class PawnRelations : public Decorator {
 public:
     PawnRelations(std::unique_ptr<Evaluator>next);
     EvalScore computeEval(const BitBoard& board, const Player botPlayer) override;
+    // the pawn structures are looked up in this thread's `PawnHash`, since they only change when a pawn moves
+    template <typename Next>
+    static EvalScore evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext);
 };
 
+template <typename Next>
+EvalScore PawnRelations::evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext)
+{
+    int score = evaluateNext().evaluation;
+    
+    const PawnHash::Entry& pawns = PawnHash::forThisThread().probe(board);
+    score += board.connectedAndStackedPawnBonus(pawns.structures[0]);
+    score += -1 * board.connectedAndStackedPawnBonus(pawns.structures[1]);
+    return EvalScore{score, false};
+}
+
 #endif
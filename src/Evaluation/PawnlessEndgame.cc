@@ -4,9 +4,5 @@ PawnlessEndgame::PawnlessEndgame(std::unique_ptr<Evaluator> next): Decorator{std
 
 EvalScore PawnlessEndgame::computeEval(const BitBoard& board, Player botPlayer)
 {
-    int score = next->computeEval(board, botPlayer).evaluation;
-    
-    score += board.mopupEvaluationBonus(Player::White);
-    score += -1 * board.mopupEvaluationBonus(Player::Black);
-    return EvalScore{score, false};
+    return evaluate(board, botPlayer, [this, &board, botPlayer]() { return next->computeEval(board, botPlayer); });
 }
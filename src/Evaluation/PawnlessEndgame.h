@@ -7,6 +7,18 @@ class PawnlessEndgame : public Decorator {
 public:
     PawnlessEndgame(std::unique_ptr<Evaluator>next);
     EvalScore computeEval(const BitBoard& board, const Player botPlayer) override;
+    template <typename Next>
+    static EvalScore evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext);
 };
 
+template <typename Next>
+EvalScore PawnlessEndgame::evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext)
+{
+    int score = evaluateNext().evaluation;
+    
+    score += board.mopupEvaluationBonus(Player::White);
+    score += -1 * board.mopupEvaluationBonus(Player::Black);
+    return EvalScore{score, false};
+}
+
 #endif
@@ -4,9 +4,5 @@ PushPawnsLateGame::PushPawnsLateGame(std::unique_ptr<Evaluator> next): Decorator
 
 EvalScore PushPawnsLateGame::computeEval(const BitBoard& board, Player botPlayer)
 {
-    int score = next->computeEval(board, botPlayer).evaluation;
-    
-    score += board.pushedPawnsLateGame(Player::White);
-    score += -1 * board.pushedPawnsLateGame(Player::Black);
-    return EvalScore{score, false};
+    return evaluate(board, botPlayer, [this, &board, botPlayer]() { return next->computeEval(board, botPlayer); });
 }
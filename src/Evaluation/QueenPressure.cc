@@ -4,9 +4,5 @@ QueenPressure::QueenPressure(std::unique_ptr<Evaluator> next): Decorator{std::mo
 
 EvalScore QueenPressure::computeEval(const BitBoard& board, Player botPlayer)
 {
-    int score = next->computeEval(board, botPlayer).evaluation;
-    
-    score += board.queenPressureBonus(Player::White);
-    score += -1 * board.queenPressureBonus(Player::Black);
-    return EvalScore{score, false};
+    return evaluate(board, botPlayer, [this, &board, botPlayer]() { return next->computeEval(board, botPlayer); });
 }
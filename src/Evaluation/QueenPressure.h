@@ -7,6 +7,18 @@ class QueenPressure : public Decorator {
 public:
     QueenPressure(std::unique_ptr<Evaluator>next);
     EvalScore computeEval(const BitBoard& board, const Player botPlayer) override;
+    template <typename Next>
+    static EvalScore evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext);
 };
 
+template <typename Next>
+EvalScore QueenPressure::evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext)
+{
+    int score = evaluateNext().evaluation;
+    
+    score += board.queenPressureBonus(Player::White);
+    score += -1 * board.queenPressureBonus(Player::Black);
+    return EvalScore{score, false};
+}
+
 #endif
@@ -4,9 +4,5 @@ RookPressure::RookPressure(std::unique_ptr<Evaluator> next): Decorator{std::move
 
 EvalScore RookPressure::computeEval(const BitBoard& board, Player botPlayer)
 {
-    int score = next->computeEval(board, botPlayer).evaluation;
-    
-    score += board.rookPressureBonus(Player::White);
-    score += -1 * board.rookPressureBonus(Player::Black);
-    return EvalScore{score, false};
+    return evaluate(board, botPlayer, [this, &board, botPlayer]() { return next->computeEval(board, botPlayer); });
 }
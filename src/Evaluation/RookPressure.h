@@ -7,6 +7,18 @@ class RookPressure : public Decorator {
 public:
     RookPressure(std::unique_ptr<Evaluator>next);
     EvalScore computeEval(const BitBoard& board, const Player botPlayer) override;
+    template <typename Next>
+    static EvalScore evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext);
 };
 
+template <typename Next>
+EvalScore RookPressure::evaluate(const BitBoard& board, const Player botPlayer, const Next& evaluateNext)
+{
+    int score = evaluateNext().evaluation;
+    
+    score += board.rookPressureBonus(Player::White);
+    score += -1 * board.rookPressureBonus(Player::Black);
+    return EvalScore{score, false};
+}
+
 #endif
@@ -1,44 +1,81 @@
 #include "Game.h"
+#include <chrono>
+#include <algorithm>
 
 float Game::whiteScore = 0.0;
 float Game::blackScore = 0.0;
 
-Game::Game(std::shared_ptr<GameBoard> gameBoard, Player currPlayer, int whiteType, int blackType) : gameBoard{gameBoard}, currPlayer{currPlayer}
+Game::Game(std::shared_ptr<GameBoard> gameBoard, Player currPlayer, int whiteType, int blackType, int hashSizeMB,
+           const SearchLimits& searchLimits, int threads, bool ponder) : gameBoard{gameBoard}, currPlayer{currPlayer}, ponder{ponder}, searchLimits{searchLimits},
+           whiteClock{searchLimits.time}, blackClock{searchLimits.time}
 {
     // assign the computers as needed based on level
     if (whiteType == 1) {
-        whiteComputer = std::make_unique<Computer>(Player::White, 1);
+        whiteComputer = std::make_unique<Computer>(Player::White, 1, hashSizeMB, threads);
     } else if (whiteType == 2) {
-        whiteComputer = std::make_unique<Computer>(Player::White, 2);
+        whiteComputer = std::make_unique<Computer>(Player::White, 2, hashSizeMB, threads);
     } else if (whiteType == 3) {
-        whiteComputer = std::make_unique<Computer>(Player::White, 3);
+        whiteComputer = std::make_unique<Computer>(Player::White, 3, hashSizeMB, threads);
     } else if (whiteType == 4) {
-        whiteComputer = std::make_unique<Computer>(Player::White, 4);
+        whiteComputer = std::make_unique<Computer>(Player::White, 4, hashSizeMB, threads);
     }
     if (blackType == 1) {
-        blackComputer = std::make_unique<Computer>(Player::Black, 1);
+        blackComputer = std::make_unique<Computer>(Player::Black, 1, hashSizeMB, threads);
     } else if (blackType == 2) {
-        blackComputer = std::make_unique<Computer>(Player::Black, 2);
+        blackComputer = std::make_unique<Computer>(Player::Black, 2, hashSizeMB, threads);
     } else if (blackType == 3) {
-        blackComputer = std::make_unique<Computer>(Player::Black, 3);
+        blackComputer = std::make_unique<Computer>(Player::Black, 3, hashSizeMB, threads);
     } else if (blackType == 4) {
-        blackComputer = std::make_unique<Computer>(Player::Black, 4);
+        blackComputer = std::make_unique<Computer>(Player::Black, 4, hashSizeMB, threads);
+    }
+    if (whiteComputer != nullptr) {
+        whiteSearch = std::make_unique<SearchThread>(*whiteComputer);
+    }
+    if (blackComputer != nullptr) {
+        blackSearch = std::make_unique<SearchThread>(*blackComputer);
     }
 }
 
 Game& Game::operator=(const Game& other)
 {
+    // the old threads search with the old computers, so they have to go first
+    whiteSearch.reset();
+    blackSearch.reset();
     gameBoard = other.gameBoard;
     currPlayer = other.currPlayer;
+    ponder = other.ponder;
+    searchLimits = other.searchLimits;
+    whiteClock = other.whiteClock;
+    blackClock = other.blackClock;
     if (other.whiteComputer != nullptr) {
         whiteComputer = std::make_unique<Computer>(*(other.whiteComputer));
+        whiteSearch = std::make_unique<SearchThread>(*whiteComputer);
+    } else {
+        whiteComputer = nullptr;
     }
     if (other.blackComputer != nullptr) {
         blackComputer = std::make_unique<Computer>(*(other.blackComputer));
+        blackSearch = std::make_unique<SearchThread>(*blackComputer);
+    } else {
+        blackComputer = nullptr;
     }
     return *this;
 }
 
+SearchThread* Game::getSearch(const Player player) const
+{
+    return (player == Player::White) ? whiteSearch.get() : blackSearch.get();
+}
+
+void Game::checkPonder(const Player player)
+{
+    // the human did not play the move the computer expected, so its thinking about that position is no use
+    SearchThread* search = getSearch(player);
+    if (search != nullptr && search->isPondering() && !(ponderBoard == gameBoard->getBitBoard())) {
+        search->stop();
+    }
+}
+
 bool Game::isValidMove(const Move move) const
 {
     return gameBoard->isValidMove(move);
@@ -57,6 +94,7 @@ void Game::makeNextMoveHuman(const Move move)
     } else {
         currPlayer = Player::White;
     }
+    checkPonder(currPlayer);
 }
 
 void Game::makeNextPromotionMoveHuman(const Move move, const Piece piece)
@@ -67,22 +105,54 @@ void Game::makeNextPromotionMoveHuman(const Move move, const Piece piece)
     } else {
         currPlayer = Player::White;
     }
+    checkPonder(currPlayer);
 }
 
 void Game::makeNextMoveComputer()
 {
+    // give the computer the time left on its own clock
+    int& clock = (currPlayer == Player::White) ? whiteClock : blackClock;
+    SearchLimits limits = searchLimits;
+    limits.time = clock;
+    const auto start = std::chrono::steady_clock::now();
+
+    SearchThread& search = *getSearch(currPlayer);
+    BitBoard board = gameBoard->getBitBoard();
+    if (search.isPondering() && ponderBoard == board) {
+        // the human played the move we expected, so the search already thinking about this position becomes the real one
+        search.ponderHit();
+    } else {
+        search.start(board, limits);
+    }
+    board.applyMove(search.wait());
+    gameBoard->setBitBoard(board);
     if (currPlayer == Player::White) {
-        gameBoard->setBitBoard(*whiteComputer->findMove(gameBoard->getBitBoard()));
         currPlayer = Player::Black;
     } else {
-        gameBoard->setBitBoard(*blackComputer->findMove(gameBoard->getBitBoard()));
         currPlayer = Player::White;
     }
+
+    // run the clock down by the time taken, then give back the increment. The clock never fully runs out,
+    // since a time of 0 would mean the computer is not on a clock at all.
+    if (searchLimits.time > 0) {
+        const int elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        clock = std::max(1, clock - elapsed) + searchLimits.increment;
+    }
+
+    // think about the reply we expect during a human's turn. The ponder search's limits only start once the human moves
+    const PackedMove reply = search.getPonderMove();
+    if (ponder && getSearch(currPlayer) == nullptr && reply.data != 0) {
+        ponderBoard = board;
+        ponderBoard.applyMove(reply);
+        limits.time = clock;
+        limits.ponder = true;
+        search.start(ponderBoard, limits);
+    }
 }
 
 bool Game::isGameOver() const
 {
-    BoardState currState = gameBoard->getState();
+    const BoardStateSimplified currState = gameBoard->getStateSimplified();
     return currState.whiteHasWin || currState.blackHasWin || currState.hasDraw;
 }
 
@@ -5,6 +5,7 @@
 #include "Player.h"
 #include "GameBoard.h"
 #include "Computer.h"
+#include "SearchThread.h"
 #include <map>
 
 class Game {
@@ -16,12 +17,31 @@ class Game {
     std::unique_ptr<Computer> whiteComputer;
     // the black player's computer (exists iff black is a computer player)
     std::unique_ptr<Computer> blackComputer;
+    // each computer thinks on its own thread, so it can keep thinking (ponder) while the other player decides on their move.
+    // these are declared after the computers so that they stop before the computers are destroyed
+    std::unique_ptr<SearchThread> whiteSearch;
+    std::unique_ptr<SearchThread> blackSearch;
+    // if a computer playing a human should ponder: think about the position after the reply it expects during the human's turn
+    bool ponder;
+    // the position a computer is pondering on, which it gets to keep thinking about if the human plays into it
+    BitBoard ponderBoard;
+    // how long the computers may think about each move
+    SearchLimits searchLimits;
+    // the time left on each computer's clock in milliseconds, if the computers are playing with a clock
+    int whiteClock;
+    int blackClock;
+    // returns the search thread of the given player, or nullptr if they are human
+    SearchThread* getSearch(const Player player) const;
+    // stops `player`'s computer from pondering if the board is not the position it is pondering on
+    void checkPonder(const Player player);
     // the score of the white player across all games
     static float whiteScore;
     // the score of the black player across all games
     static float blackScore;
 public:
-    Game(std::shared_ptr<GameBoard> gameBoard, Player currentPlayer, int whiteType, int blackType);
+    // `hashSizeMB` is the size of the transposition table given to each computer player, and `threads` is how many threads each one searches with
+    Game(std::shared_ptr<GameBoard> gameBoard, Player currentPlayer, int whiteType, int blackType, int hashSizeMB = Hash::defaultSizeMB,
+         const SearchLimits& searchLimits = SearchLimits{}, int threads = 1, bool ponder = false);
     Game& operator=(const Game& other);
 
     // checks if a given move is valid for the game state
@@ -32,7 +52,8 @@ public:
     void makeNextMoveHuman(const Move move);
     // makes the next move assuming it is a human's turn and the move is valid and it is a promotion move
     void makeNextPromotionMoveHuman(const Move move, const Piece piece);
-    // makes the next move assuming it is a computer's turn and the move is valid (already checked)
+    // makes the next move assuming it is a computer's turn and the move is valid (already checked).
+    // the search runs on the computer's own thread; this waits for it
     void makeNextMoveComputer();
     // checks if the game is over
     bool isGameOver() const;
@@ -13,6 +13,15 @@ BoardState GameBoard::getState() const
     }
 }
 
+BoardStateSimplified GameBoard::getStateSimplified() const
+{
+    // a game can not end while it is being set up
+    if (setupMode) {
+        return BoardStateSimplified(false, false, false);
+    }
+    return board.getStateSimplified();
+}
+
 bool GameBoard::isValidMove(const Move& move) const
 {
     return board.isValidMove(move);
@@ -20,24 +29,7 @@ bool GameBoard::isValidMove(const Move& move) const
 
 bool GameBoard::isValidPromotionMove(const Move& move, const Piece& piece) const
 {
-    // get a copy of our current bit board
-    BitBoard currBoard = board;
-    // get valid next moves
-    std::vector<std::shared_ptr<BitBoard>> nextBoards = currBoard.generateValidNextPositions();
-    // make the move
-    currBoard.makePlayerMove(move);
-    // if the piece is valid set the piece for promotion
-    currBoard.removePiece(move.end);
-    currBoard.setPiece(move.end, piece);
-    // check if the result is valid
-    bool validPromotionMove = false;
-    for (auto& option : nextBoards) {
-        if (*option == currBoard) {
-            validPromotionMove = true;
-            break;
-        }
-    }
-    return validPromotionMove;
+    return board.isValidPromotionMove(move, piece);
 }
 
 void GameBoard::makePlayerMove(const Move& move)
@@ -48,9 +40,7 @@ void GameBoard::makePlayerMove(const Move& move)
 
 void GameBoard::makePlayerPromotionMove(const Move& move, const Piece& piece)
 {
-    board.makePlayerMove(move);
-    board.removePiece(move.end);
-    board.setPiece(move.end, piece);
+    board.makePlayerPromotionMove(move, piece);
     notifyObservers();
 }
 
@@ -81,6 +71,11 @@ std::vector<std::shared_ptr<BitBoard>> GameBoard::generateValidNextPositions() c
     return board.generateValidNextPositions();
 }
 
+bool GameBoard::hasAnyLegalMove() const
+{
+    return board.hasAnyLegalMove();
+}
+
 void GameBoard::setBoardToBeEmpty()
 {
     board.setBoardToBeEmpty();
@@ -13,6 +13,8 @@ public:
 
     // call right before a player makes a move for their turn
     BoardState getState() const;
+    // returns only whether the game is won or drawn, which is much cheaper than `getState`
+    BoardStateSimplified getStateSimplified() const;
 
     // returns if a move is allowed to be played in the current position
     bool isValidMove(const Move& move) const;
@@ -46,6 +48,9 @@ public:
 
     std::vector<std::shared_ptr<BitBoard>> generateValidNextPositions() const;
 
+    // returns if the current player has a legal move
+    bool hasAnyLegalMove() const;
+
     // this removes all pieces, and sets all temporal information to 0 (disables castling rights and sets player to white)
     void setBoardToBeEmpty();
 
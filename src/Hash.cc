@@ -1,66 +1,133 @@
 #include "Hash.h"
+#include <bit>
+#include <climits>
+#include <algorithm>
 
-U64 Hash::hashPower(U64 base, U64 exponent) const
+Hash::Hash(const int megabytes)
 {
-    // calculate the power value, taking mod each time to avoid overflow
-    U64 ans = 1;
-    base %= mod;
-    while (exponent > 0) {
-        ans *= base;
-        ans %= mod;
-        exponent--;
-    }
-    return ans;
+    resize(megabytes);
 }
 
-U64 Hash::getHashKey(const BitBoard& board, const int depth) const
+Hash::Hash(const Hash& other) : table(other.table.size()), bucketMask{other.bucketMask} {}
+
+void Hash::resize(const int megabytes)
 {
-    // assign exponent 13-2 to the bitboard state, and sum these
-    U64 exponent = 13;
-    U64 hash = 0;
-    for (int i = 0; i < 12; i++) {
-        hash += hashPower(board.pieces[i], exponent);
-        hash %= mod;
-        exponent--;
-    }
-    // assign exponent 1 to the temporal info
-    hash += hashPower(board.temporalInfo, exponent);
-    hash %= mod;
-    // assign exponent 0 to the depth
-    hash += depth;
-    hash %= mod;
-    return hash;
+    // round the number of buckets down to a power of two, so that a key can be mapped to a bucket with a mask
+    const U64 requestedBuckets = (static_cast<U64>(std::max(megabytes, 1)) << 20) / sizeof(Bucket);
+    const U64 bucketCount = std::bit_floor(requestedBuckets);
+    std::vector<Bucket>(bucketCount).swap(table);
+    bucketMask = bucketCount - 1;
+    age = 0;
 }
 
-void Hash::setKeyValue(const U64 key, const bool maxTurn, const U64 value)
+void Hash::clear()
 {
-    if (maxTurn) {
-        maxTable[key] = value;
-    } else {
-        minTable[key] = value;
+    for (auto& bucket : table) {
+        for (auto& entry : bucket.entries) {
+            entry.keyXorData.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
     }
+    age = 0;
+}
+
+void Hash::newSearch()
+{
+    ++age;
+}
+
+U64 Hash::packData(const int score, const PackedMove bestMove, const int depth, const Bound bound, const uint8_t age)
+{
+    return static_cast<U64>(static_cast<uint32_t>(score))
+        | (static_cast<U64>(bestMove.data) << 32)
+        | (static_cast<U64>(static_cast<uint8_t>(depth)) << 48)
+        | (static_cast<U64>(bound) << 56)
+        | (static_cast<U64>(age & 0x3F) << 58);
+}
+
+HashEntry Hash::unpackData(const U64 data)
+{
+    HashEntry entry;
+    entry.score = static_cast<int32_t>(static_cast<uint32_t>(data));
+    entry.bestMove.data = static_cast<uint16_t>(data >> 32);
+    entry.depth = static_cast<uint8_t>(data >> 48);
+    entry.bound = static_cast<Bound>((data >> 56) & 0x3);
+    return entry;
 }
 
-U64 Hash::getValue(const U64 key, const bool maxTurn)
+uint8_t Hash::getAge(const U64 data)
 {
-    if (maxTurn) {
-        return maxTable[key];
-    } else {
-        return minTable[key];
+    return (data >> 58) & 0x3F;
+}
+
+Hash::Bucket& Hash::getBucket(const U64 key)
+{
+    return table[key & bucketMask];
+}
+
+const Hash::Bucket& Hash::getBucket(const U64 key) const
+{
+    return table[key & bucketMask];
+}
+
+bool Hash::probe(const U64 key, HashEntry& entry) const
+{
+    for (const auto& slot : getBucket(key).entries) {
+        const U64 data = slot.data.load(std::memory_order_relaxed);
+        const U64 keyXorData = slot.keyXorData.load(std::memory_order_relaxed);
+        if ((keyXorData ^ data) == key && data != 0) {
+            entry = unpackData(data);
+            return true;
+        }
     }
+    return false;
 }
 
-bool Hash::keyExists(const U64 key, const bool maxTurn) const
+void Hash::store(const U64 key, const int score, const int depth, const Bound bound, const PackedMove bestMove)
 {
-    if (maxTurn) {
-        return maxTable.count(key);
-    } else {
-        return minTable.count(key);
+    Bucket& bucket = getBucket(key);
+    const uint8_t currentAge = age & 0x3F;
+
+    // replace this position's own entry if it has one. Otherwise, pick the entry worth the least:
+    // empty entries first, then the shallowest, counting entries from older searches as much shallower
+    Entry* replace = &bucket.entries[0];
+    int replaceWorth = INT_MAX;
+    for (auto& slot : bucket.entries) {
+        const U64 data = slot.data.load(std::memory_order_relaxed);
+        const U64 keyXorData = slot.keyXorData.load(std::memory_order_relaxed);
+        if ((keyXorData ^ data) == key) {
+            // keep a deeper result for this position from the current search, unless it is only a bound
+            // and we now have an exact score
+            const HashEntry existing = unpackData(data);
+            if (getAge(data) == currentAge && existing.depth > depth && bound != Bound::Exact) {
+                return;
+            }
+            // keep the old best move if this search of the position did not find one
+            const PackedMove move = (bestMove.data == 0) ? existing.bestMove : bestMove;
+            const U64 newData = packData(score, move, depth, bound, currentAge);
+            slot.data.store(newData, std::memory_order_relaxed);
+            slot.keyXorData.store(key ^ newData, std::memory_order_relaxed);
+            return;
+        }
+        int worth;
+        if (data == 0) {
+            worth = INT_MIN;
+        } else {
+            const int ageDifference = (currentAge - getAge(data)) & 0x3F;
+            worth = unpackData(data).depth - 8 * ageDifference;
+        }
+        if (worth < replaceWorth) {
+            replaceWorth = worth;
+            replace = &slot;
+        }
     }
+
+    const U64 newData = packData(score, bestMove, depth, bound, currentAge);
+    replace->data.store(newData, std::memory_order_relaxed);
+    replace->keyXorData.store(key ^ newData, std::memory_order_relaxed);
 }
 
-void Hash::clearHashTables()
+int Hash::getSizeMB() const
 {
-    maxTable.clear();
-    minTable.clear();
-}
\ No newline at end of file
+    return static_cast<int>((table.size() * sizeof(Bucket)) >> 20);
+}
@@ -2,28 +2,81 @@
 #define HASH_H
 
 #include "BitBoard.h"
-#include <unordered_map>
+#include "PackedMove.h"
+#include <atomic>
+#include <vector>
 
+// what a stored score says about the true score of its position
+enum class Bound : uint8_t {
+    None = 0,  // the entry is empty
+    Exact = 1, // the score is the true score at its depth
+    Lower = 2, // the true score is at least the stored score (the search failed high)
+    Upper = 3  // the true score is at most the stored score (the search failed low)
+};
+
+// the information recovered from the transposition table for a position
+struct HashEntry {
+    int score = 0;
+    int depth = 0;
+    Bound bound = Bound::None;
+    PackedMove bestMove{};
+};
+
+/*
+ * A fixed-size transposition table. It is preallocated as a power-of-two number of buckets, where each bucket
+ * fills exactly one cache line, so a probe touches a single line of memory. The table is kept between searches,
+ * and each search bumps the table's age so that entries from earlier moves are replaced first.
+ *
+ * Every entry is two 64-bit words: the packed data, and the position's key XOR-ed with that data. A reader only
+ * accepts an entry if XOR-ing the two words gives back its key, so an entry that is torn by two threads writing
+ * it at once reads as a miss. This lets the table be shared between threads without any locks.
+ */
 class Hash {
-    // a hash table for the min player and the max player, since a collision would be very bad between the two
-    std::unordered_map<U64, U64> minTable;
-    std::unordered_map<U64, U64> maxTable;
-    // our mod value for the hash (large prime)
-    const U64 mod = static_cast<int>(1e9 + 7);
-    // obtain the hash for a base, exponent pair using our mod
-    U64 hashPower(U64 base, U64 exponent) const;
+    struct Entry {
+        std::atomic<U64> keyXorData{0};
+        std::atomic<U64> data{0};
+    };
+    static const int entriesPerBucket = 4;
+    struct alignas(64) Bucket {
+        Entry entries[entriesPerBucket];
+    };
+
+    std::vector<Bucket> table;
+    // the number of buckets minus one, used to turn a key into a bucket index
+    U64 bucketMask = 0;
+    // bumped by every search; only the low 6 bits are stored in the entries
+    uint8_t age = 0;
+
+    // data is packed as: bits 0-31 score, bits 32-47 best move, bits 48-55 depth, bits 56-57 bound, bits 58-63 age
+    static U64 packData(const int score, const PackedMove bestMove, const int depth, const Bound bound, const uint8_t age);
+    static HashEntry unpackData(const U64 data);
+    static uint8_t getAge(const U64 data);
+
+    // the bucket that a given key lives in
+    Bucket& getBucket(const U64 key);
+    const Bucket& getBucket(const U64 key) const;
 public:
-    // given a board and a depth, get our hash key using complete information from the board
-    U64 getHashKey(const BitBoard& board, const int depth) const;
-    // set a key value pair in our table for min/max turn
-    void setKeyValue(const U64 key, const bool maxTurn, const U64 value);
-    // get value for given key and min/max turn
-    U64 getValue(const U64 key, const bool maxTurn);
-    // check if key exists for min/max turn
-    bool keyExists(const U64 key, const bool maxTurn) const;
-
-    // clears the hash tables
-    void clearHashTables();
+    static const int defaultSizeMB = 16;
+
+    // creates a table using (at most) the given number of megabytes
+    explicit Hash(const int megabytes = defaultSizeMB);
+    // creates an empty table of the same size as another
+    Hash(const Hash& other);
+
+    // reallocates the table to use (at most) the given number of megabytes. This empties the table.
+    void resize(const int megabytes);
+    // removes every entry from the table
+    void clear();
+    // marks the start of a new search, so that entries from older searches are preferred for replacement
+    void newSearch();
+
+    // looks up a position by its Zobrist key, returning true and filling `entry` iff it is in the table
+    bool probe(const U64 key, HashEntry& entry) const;
+    // stores the result of searching a position to a given depth
+    void store(const U64 key, const int score, const int depth, const Bound bound, const PackedMove bestMove);
+
+    // the size of the table in megabytes
+    int getSizeMB() const;
 };
 
 #endif
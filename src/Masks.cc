@@ -2,22 +2,30 @@
 #include <cstdint>
 #include <vector>
 #include <memory>
+#include <bit>
 #include "Masks.h"
 
 // this constructor instantiates all the masks.
-Masks::Masks() : fileMasks{generateFileMasks()}, fileNotMasks{flipMasks(generateFileMasks())}, rankMasks{generateRankMasks()},
+Masks::Masks() :
+#ifdef MASKS_HAS_PEXT
+        usePext{static_cast<bool>(__builtin_cpu_supports("bmi2"))},
+#else
+        usePext{false},
+#endif
+        rookAttackTable(0x19000), bishopAttackTable(0x1480), fileMasks{generateFileMasks()}, fileNotMasks{flipMasks(generateFileMasks())}, rankMasks{generateRankMasks()},
         rankNotMasks{flipMasks(generateRankMasks())}, rookAttackMasks{generateRookAttackMasks()},
         bishopAttackMasks{generateBishopAttackMasks()}, queenAttackMasks{generateQueenAttackMasks()},
         knightAttackMasks{generateKnightAttackMasks()}, kingAttackMasks{generateKingAttackMasks()}, threeByThreeSquareMask{generateThreeByThreeSquareMasks()},
         whitePawnAttackMasks{generateWhitePawnAttackMasks()}, whitePawnMoveMasks{generateWhitePawnMoveMasks()},
         blackPawnAttackMasks{generateBlackPawnAttackMasks()}, blackPawnMoveMasks{generateBlackPawnMoveMasks()},
-        attackRayRight{generateAttackRay(1,0)}, attackRayDiagonalUpRight{generateAttackRay(1,1)}, 
-        attackRayUp{generateAttackRay(0,1)}, attackRayDiagonalUpLeft{generateAttackRay(-1,1)}, 
-        attackRayLeft{generateAttackRay(-1,0)}, attackRayDiagonalDownLeft{generateAttackRay(-1,-1)}, 
-        attackRayDown{generateAttackRay(0,-1)}, attackRayDiagonalDownRight{generateAttackRay(1,-1)} {}
+        betweenMasks{generateBetweenMasks()}, lineMasks{generateLineMasks()}
+{
+    generateMagics(rookMagics, rookAttackTable, true);
+    generateMagics(bishopMagics, bishopAttackTable, false);
+}
 
 // this is used for a client to get access to the Masks singleton.
-shared_ptr<Masks> Masks::getMasks() 
+const shared_ptr<Masks>& Masks::getMasks() 
 {
     static shared_ptr<Masks> masks(new Masks); // this line uses the "magic static" C++ feature to create a singleton.
                                                // this variable is instantiated only the first time the method is run.
@@ -324,31 +332,142 @@ std::vector<U64> Masks::generateBlackPawnAttackMasks()
     return masks;
 }
 
-std::vector<std::vector<U64>> Masks::generateAttackRay(const int fileDelta, const int rankDelta)
+std::vector<U64> Masks::generateBetweenMasks()
 {
-    std::vector<std::vector<U64>> masks(64);
-    for (int rank = 0; rank < 8; ++rank) {
-        for (int file = 0; file < 8; ++file) {
-
-            // for each position on the board, keep casting a ray in the (fileDelta, rankDelta) direction.
-            std::vector<U64> raysFromTile;
-            int curFile = file + fileDelta;
-            int curRank = rank + rankDelta;
+    static const int deltas[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    std::vector<U64> masks(64 * 64, 0ull);
+    for (int position = 0; position < 64; ++position) {
+        for (const auto& delta : deltas) {
+            // walk away from `position`, and every tile we reach has the tiles walked over so far between it and `position`
+            U64 between = 0ull;
+            int curFile = position % 8 + delta[0];
+            int curRank = position / 8 + delta[1];
             while (0 <= curFile && curFile < 8 && 0 <= curRank && curRank < 8) {
-
-                // as the ray is being casted as far as it can go in the (fileDelta, rankDelta) direction,
-                // keep adding on new bits/tiles in that direction.
-                raysFromTile.push_back((1ull << (curRank*8 + curFile)));
-                curFile += fileDelta;
-                curRank += rankDelta;
+                masks[position * 64 + curRank*8 + curFile] = between;
+                between |= (1ull << (curRank*8 + curFile));
+                curFile += delta[0];
+                curRank += delta[1];
             }
-            masks[rank*8 + file] = raysFromTile;
         }
     }
+    return masks;
+}
 
+std::vector<U64> Masks::generateLineMasks()
+{
+    // each direction is paired with its opposite, so that casting both rays gives the whole line
+    static const int deltas[4][4][2] = {{{1, 0}, {-1, 0}, {1, 0}, {-1, 0}}, {{0, 1}, {0, -1}, {0, 1}, {0, -1}},
+                                        {{1, 1}, {-1, -1}, {1, 1}, {-1, -1}}, {{1, -1}, {-1, 1}, {1, -1}, {-1, 1}}};
+    std::vector<U64> masks(64 * 64, 0ull);
+    for (int position = 0; position < 64; ++position) {
+        for (const auto& lineDeltas : deltas) {
+            const U64 line = slidingAttacks(position, 0ull, lineDeltas) | (1ull << position);
+            U64 others = line & ~(1ull << position);
+            while (others) {
+                masks[position * 64 + std::countr_zero(others)] = line;
+                others &= others - 1;
+            }
+        }
+    }
     return masks;
 }
 
+U64 Masks::slidingAttacks(const int position, const U64 occupiedMask, const int deltas[4][2])
+{
+    U64 attacks = 0ull;
+    for (int direction = 0; direction < 4; ++direction) {
+        const int fileDelta = deltas[direction][0];
+        const int rankDelta = deltas[direction][1];
+
+        // keep casting a ray in the (fileDelta, rankDelta) direction until it leaves the board or collides with a piece.
+        int curFile = position % 8 + fileDelta;
+        int curRank = position / 8 + rankDelta;
+        while (0 <= curFile && curFile < 8 && 0 <= curRank && curRank < 8) {
+            const U64 tile = (1ull << (curRank*8 + curFile));
+            attacks |= tile;
+            if (occupiedMask & tile) {
+                break;
+            }
+            curFile += fileDelta;
+            curRank += rankDelta;
+        }
+    }
+    return attacks;
+}
+
+void Masks::generateMagics(Magic magics[64], std::vector<U64>& attackTable, const bool isRook)
+{
+    const int rookDeltas[4][2] = {{1,0}, {0,1}, {-1,0}, {0,-1}};
+    const int bishopDeltas[4][2] = {{1,1}, {-1,1}, {-1,-1}, {1,-1}};
+    const int (*deltas)[2] = isRook ? rookDeltas : bishopDeltas;
+
+    // seeds (one per rank) for the random number generator that were found to give magic numbers quickly
+    const U64 seeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+
+    std::vector<U64> occupancies(4096);
+    std::vector<U64> reference(4096);
+    std::vector<int> epoch(4096, 0);
+    int attempt = 0;
+    U64* nextAttacks = attackTable.data();
+
+    for (int position = 0; position < 64; ++position) {
+        Magic& magic = magics[position];
+
+        // pieces on the edge of the board can never block a slider from attacking anything further, so they are not relevant
+        // (unless the slider is on that edge itself)
+        const U64 edges = ((0x00000000000000FFull | 0xFF00000000000000ull) & ~(0x00000000000000FFull << (position / 8 * 8)))
+                        | ((0x0101010101010101ull | 0x8080808080808080ull) & ~(0x0101010101010101ull << (position % 8)));
+        magic.mask = slidingAttacks(position, 0ull, deltas) & ~edges;
+        magic.shift = 64 - std::popcount(magic.mask);
+        magic.attacks = nextAttacks;
+
+        // go through every subset of the relevant occupancy bits, and find the attacks for each
+        int size = 0;
+        U64 occupancy = 0ull;
+        do {
+            occupancies[size] = occupancy;
+            reference[size] = slidingAttacks(position, occupancy, deltas);
+            if (usePext) {
+                magic.attacks[pextIndex(occupancy, magic.mask)] = reference[size];
+            }
+            ++size;
+            occupancy = (occupancy - magic.mask) & magic.mask;
+        } while (occupancy);
+        nextAttacks += size;
+
+        if (usePext) {
+            continue;
+        }
+
+        // try random sparse numbers until one maps every occupancy to an index without a conflicting collision
+        U64 seed = seeds[position / 8];
+        auto random = [&seed]() {
+            seed ^= seed >> 12;
+            seed ^= seed << 25;
+            seed ^= seed >> 27;
+            return seed * 2685821657736338717ull;
+        };
+        for (int i = 0; i < size; ) {
+            magic.magic = 0ull;
+            while (std::popcount((magic.magic * magic.mask) >> 56) < 6) {
+                magic.magic = random() & random() & random();
+            }
+
+            // `epoch` lets us tell which table entries were written during this attempt without clearing the table each time
+            ++attempt;
+            for (i = 0; i < size; ++i) {
+                const unsigned index = ((occupancies[i] & magic.mask) * magic.magic) >> magic.shift;
+                if (epoch[index] < attempt) {
+                    epoch[index] = attempt;
+                    magic.attacks[index] = reference[i];
+                } else if (magic.attacks[index] != reference[i]) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
 const int Masks::knightPositionBonus[2][64] = {{
 
     // WHITE
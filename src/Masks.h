@@ -6,6 +6,11 @@
 #include <vector>
 #include <memory>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MASKS_HAS_PEXT
+#endif
+
 using namespace std;
 using U64 = uint64_t;
 
@@ -36,8 +41,38 @@ private:
     static std::vector<U64> generateBlackPawnMoveMasks();
     static std::vector<U64> generateWhitePawnAttackMasks();
     static std::vector<U64> generateBlackPawnAttackMasks();
+    // these have an entry for every pair of tiles (see `betweenMask` and `lineMask`), indexed by `first * 64 + second`
+    static std::vector<U64> generateBetweenMasks();
+    static std::vector<U64> generateLineMasks();
+
+    // a magic bitboard entry for one tile: the occupancy bits that can block a slider on that tile, the magic multiplier
+    // and shift that hash those bits into a table index, and where this tile's attack sets start in the attack table
+    struct Magic {
+        U64 mask;
+        U64 magic;
+        unsigned shift;
+        U64* attacks;
+    };
+
+    // casts rays from `position` in each (fileDelta, rankDelta) direction, stopping at (and including) the first occupied tile.
+    // this is the slow reference used to fill in the attack tables.
+    static U64 slidingAttacks(const int position, const U64 occupiedMask, const int deltas[4][2]);
+
+    // fills in `magics` and `attackTable` for a rook (or bishop if `isRook` is false), finding magic numbers unless `usePext` is set
+    void generateMagics(Magic magics[64], std::vector<U64>& attackTable, const bool isRook);
 
-    static std::vector<std::vector<U64>> generateAttackRay(const int fileDelta, const int rankDelta);
+    // the table index for `occupiedMask` using the BMI2 PEXT instruction. Only call this if `usePext` is set.
+    inline static unsigned pextIndex(const U64 occupiedMask, const U64 mask);
+
+    // whether the CPU supports BMI2, so that slider lookups index their tables with PEXT instead of a magic multiplication
+    const bool usePext;
+
+    Magic rookMagics[64];
+    Magic bishopMagics[64];
+    std::vector<U64> rookAttackTable;
+    std::vector<U64> bishopAttackTable;
+
+    inline U64 sliderAttacks(const Magic& magic, const U64 occupiedMask) const;
 
 public:
     const std::vector<U64> fileMasks;
@@ -54,6 +89,8 @@ public:
     const std::vector<U64> whitePawnMoveMasks;
     const std::vector<U64> blackPawnAttackMasks;
     const std::vector<U64> blackPawnMoveMasks;
+    const std::vector<U64> betweenMasks;
+    const std::vector<U64> lineMasks;
 
 
     // 10101010
@@ -81,18 +118,77 @@ public:
     static const int whiteKingEarlyGame[64];
     static const int blackKingEarlyGame[64];
 
-    std::vector<std::vector<U64>> attackRayRight;
-    std::vector<std::vector<U64>> attackRayDiagonalUpRight;
-    std::vector<std::vector<U64>> attackRayUp;
-    std::vector<std::vector<U64>> attackRayDiagonalUpLeft;
-    std::vector<std::vector<U64>> attackRayLeft;
-    std::vector<std::vector<U64>> attackRayDiagonalDownLeft;
-    std::vector<std::vector<U64>> attackRayDown;
-    std::vector<std::vector<U64>> attackRayDiagonalDownRight;
+    // these return the tiles a rook, bishop, or queen at `position` attacks, given which tiles are occupied.
+    // the attacks stop at (and include) the first piece in each direction, whatever its colour.
+    // each is a single lookup in a table precomputed for every relevant occupancy.
+    inline U64 rookAttacks(const int position, const U64 occupiedMask) const;
+    inline U64 bishopAttacks(const int position, const U64 occupiedMask) const;
+    inline U64 queenAttacks(const int position, const U64 occupiedMask) const;
+
+    // returns the tiles strictly between `first` and `second` if they share a rank, file, or diagonal, and 0 otherwise.
+    // a piece that checks the king from afar can be blocked on any of these tiles.
+    inline U64 betweenMask(const int first, const int second) const;
+    // returns the whole rank, file, or diagonal through `first` and `second` (from edge to edge), or 0 if they do not share one.
+    // a piece pinned to its king can only move along the line through the two of them.
+    inline U64 lineMask(const int first, const int second) const;
 
-    static shared_ptr<Masks> getMasks();
+    // returns a reference so that callers (which may be on several search threads at once) do not have to
+    // touch the shared reference count every time they need the masks
+    static const shared_ptr<Masks>& getMasks();
 
     static void printMask(const U64 mask);
 };
 
+// when the whole program is built for BMI2 (such as with `-march=native`), this is a single inlined instruction. Otherwise only
+// this function is built for BMI2, since the rest may run on a CPU without it, and the compiler can not inline it into them
+#if defined(MASKS_HAS_PEXT) && defined(__BMI2__)
+inline unsigned Masks::pextIndex(const U64 occupiedMask, const U64 mask)
+{
+    return _pext_u64(occupiedMask, mask);
+}
+#elif defined(MASKS_HAS_PEXT)
+__attribute__((target("bmi2"))) inline unsigned Masks::pextIndex(const U64 occupiedMask, const U64 mask)
+{
+    return _pext_u64(occupiedMask, mask);
+}
+#else
+inline unsigned Masks::pextIndex(const U64, const U64)
+{
+    return 0;
+}
+#endif
+
+inline U64 Masks::sliderAttacks(const Magic& magic, const U64 occupiedMask) const
+{
+    if (usePext) {
+        return magic.attacks[pextIndex(occupiedMask, magic.mask)];
+    }
+    return magic.attacks[((occupiedMask & magic.mask) * magic.magic) >> magic.shift];
+}
+
+inline U64 Masks::rookAttacks(const int position, const U64 occupiedMask) const
+{
+    return sliderAttacks(rookMagics[position], occupiedMask);
+}
+
+inline U64 Masks::bishopAttacks(const int position, const U64 occupiedMask) const
+{
+    return sliderAttacks(bishopMagics[position], occupiedMask);
+}
+
+inline U64 Masks::queenAttacks(const int position, const U64 occupiedMask) const
+{
+    return rookAttacks(position, occupiedMask) | bishopAttacks(position, occupiedMask);
+}
+
+inline U64 Masks::betweenMask(const int first, const int second) const
+{
+    return betweenMasks[first * 64 + second];
+}
+
+inline U64 Masks::lineMask(const int first, const int second) const
+{
+    return lineMasks[first * 64 + second];
+}
+
 #endif
@@ -0,0 +1,29 @@
+#ifndef MOVELIST_H
+#define MOVELIST_H
+
+#include "PackedMove.h"
+
+// A fixed-capacity list of moves that lives on the stack, so that generating moves never allocates.
+// 256 is safely above the largest number of legal moves any chess position can have (218).
+class MoveList {
+    static const int capacity = 256;
+
+    // intentionally left uninitialized; only the first `count` moves are ever read
+    PackedMove moves[capacity];
+    int count = 0;
+public:
+    void push(const PackedMove move) { moves[count++] = move; }
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    PackedMove& operator[](const int index) { return moves[index]; }
+    PackedMove operator[](const int index) const { return moves[index]; }
+
+    PackedMove* begin() { return moves; }
+    PackedMove* end() { return moves + count; }
+    const PackedMove* begin() const { return moves; }
+    const PackedMove* end() const { return moves + count; }
+};
+
+#endif
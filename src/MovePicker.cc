@@ -0,0 +1,175 @@
+#include "MovePicker.h"
+#include <algorithm>
+#include <cstdlib>
+
+void MoveHistory::clear()
+{
+    std::fill(&killers[0][0], &killers[0][0] + maxPly * 2, PackedMove{});
+    std::fill(&counterMoves[0][0], &counterMoves[0][0] + 64 * 64, PackedMove{});
+    std::fill(&history[0][0][0], &history[0][0][0] + 2 * 64 * 64, 0);
+}
+
+void MoveHistory::age()
+{
+    std::fill(&killers[0][0], &killers[0][0] + maxPly * 2, PackedMove{});
+    std::for_each(&history[0][0][0], &history[0][0][0] + 2 * 64 * 64, [](int& score) { score /= 2; });
+}
+
+void MoveHistory::updateQuiet(const int side, const int ply, const int depth, const PackedMove move, const PackedMove previousMove,
+                              const PackedMove* triedMoves, const int triedCount)
+{
+    if (ply < maxPly && !(killers[ply][0] == move)) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = move;
+    }
+    if (previousMove.data != 0) {
+        counterMoves[previousMove.getStart()][previousMove.getEnd()] = move;
+    }
+
+    // cutoffs deeper in the tree are worth more. Each change is scaled down as a score nears `maxHistory`, so that scores
+    // stay in range and a move that stops causing cutoffs drops back quickly
+    const int bonus = std::min(depth * depth, 400);
+    const auto adjust = [this, side](const PackedMove m, const int change) {
+        int& score = history[side][m.getStart()][m.getEnd()];
+        score += change - score * std::abs(change) / maxHistory;
+    };
+    adjust(move, bonus);
+    for (int i = 0; i < triedCount; ++i) {
+        adjust(triedMoves[i], -bonus);
+    }
+}
+
+MovePicker::MovePicker(const BitBoard& board, const PackedMove hashMove, const MoveHistory& moveHistory, const int ply, const PackedMove previousMove,
+                       const bool capturesOnly):
+    board{board}, hashMove{hashMove}, moveHistory{moveHistory}, side{board.getCurrentPlayer() == Player::White ? 0 : 1}
+{
+    if (capturesOnly) {
+        board.generateCaptures(moves);
+    } else {
+        board.generateMoves(moves);
+    }
+    const auto quiet = std::partition(moves.begin(), moves.end(), [](const PackedMove move) { return move.isCapture() || move.isPromotion(); });
+    captureCount = quiet - moves.begin();
+
+    int refutationCount = 0;
+    if (ply < MoveHistory::maxPly) {
+        refutations[refutationCount++] = moveHistory.killers[ply][0];
+        refutations[refutationCount++] = moveHistory.killers[ply][1];
+    }
+    if (previousMove.data != 0) {
+        refutations[refutationCount++] = moveHistory.counterMoves[previousMove.getStart()][previousMove.getEnd()];
+    }
+    // unused slots are left empty, which never match a move
+    for (int i = refutationCount; i < 3; ++i) {
+        refutations[i] = PackedMove{};
+    }
+}
+
+PackedMove MovePicker::pickBest(const int end)
+{
+    while (next < end) {
+        int best = next;
+        for (int i = next + 1; i < end; ++i) {
+            if (scores[i] > scores[best]) {
+                best = i;
+            }
+        }
+        std::swap(moves[next], moves[best]);
+        std::swap(scores[next], scores[best]);
+        const PackedMove move = moves[next++];
+        // the hash move was already handed out first
+        if (!(move == hashMove)) {
+            return move;
+        }
+    }
+    return PackedMove{};
+}
+
+bool MovePicker::takeQuiet(const PackedMove move)
+{
+    for (int i = next; i < moves.size(); ++i) {
+        if (moves[i] == move) {
+            std::swap(moves[next], moves[i]);
+            return true;
+        }
+    }
+    return false;
+}
+
+PackedMove MovePicker::nextMove()
+{
+    switch (stage) {
+    case Stage::HashMove:
+        stage = Stage::ScoreCaptures;
+        // the hash move came from the table, which can have a move from another position that shares its bucket
+        if (hashMove.data != 0 && std::find(moves.begin(), moves.end(), hashMove) != moves.end()) {
+            return hashMove;
+        }
+        [[fallthrough]];
+
+    case Stage::ScoreCaptures:
+        for (int i = 0; i < captureCount; ++i) {
+            const PackedMove move = moves[i];
+            const int attacker = board.getPiece(move.getStart()) % 6;
+            int victimValue = pieceValues[move.getPromotion()];
+            if (move.isEnPassant()) {
+                victimValue += pieceValues[Piece::P];
+            } else if (move.isCapture()) {
+                victimValue += pieceValues[board.getPiece(move.getEnd()) % 6];
+            }
+            scores[i] = victimValue * 16 - pieceValues[attacker];
+        }
+        stage = Stage::Captures;
+        [[fallthrough]];
+
+    case Stage::Captures:
+        for (PackedMove move = pickBest(captureCount); move.data != 0; move = pickBest(captureCount)) {
+            // taking a piece worth at least the attacker can not lose material, so only the others need the exchange worked out
+            const int attackerValue = pieceValues[board.getPiece(move.getStart()) % 6];
+            const bool winsAttacker = move.isCapture() && !move.isEnPassant() && pieceValues[board.getPiece(move.getEnd()) % 6] >= attackerValue;
+            if (winsAttacker || board.see(move) >= 0) {
+                return move;
+            }
+            badCaptures.push(move);
+        }
+        stage = Stage::Killers;
+        [[fallthrough]];
+
+    case Stage::Killers:
+        while (refutationIndex < 3) {
+            const PackedMove move = refutations[refutationIndex++];
+            if (move.data != 0 && !(move == hashMove) && takeQuiet(move)) {
+                ++next;
+                return move;
+            }
+        }
+        stage = Stage::BadCaptures;
+        [[fallthrough]];
+
+    case Stage::BadCaptures:
+        if (badCaptureIndex < badCaptures.size()) {
+            return badCaptures[badCaptureIndex++];
+        }
+        stage = Stage::Quiets;
+        // the quiet moves are only scored once we get to them, which we often do not
+        for (int i = next; i < moves.size(); ++i) {
+            const PackedMove move = moves[i];
+            scores[i] = moveHistory.history[side][move.getStart()][move.getEnd()];
+        }
+        [[fallthrough]];
+
+    case Stage::Quiets:
+        {
+            const PackedMove move = pickBest(moves.size());
+            if (move.data != 0) {
+                return move;
+            }
+        }
+        stage = Stage::Done;
+        [[fallthrough]];
+
+    case Stage::Done:
+        break;
+    }
+    return PackedMove{};
+}
@@ -0,0 +1,94 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include "BitBoard.h"
+#include "MoveList.h"
+#include "PackedMove.h"
+
+// The move ordering statistics that a search thread learns as it searches, which `MovePicker` uses to guess which
+// quiet (non-capturing) moves are best. They are kept between searches, but become less important with each new one.
+struct MoveHistory {
+    // the deepest ply (distance from the root) that killer moves are kept for
+    static const int maxPly = 128;
+    // the most a history score can grow to in either direction
+    static const int maxHistory = 16384;
+
+    // two quiet moves per ply that recently caused a beta cutoff at that ply. A move that refutes one position often refutes
+    // its siblings too
+    PackedMove killers[maxPly][2];
+    // the quiet move that last caused a beta cutoff in reply to the move with the given start and end positions
+    PackedMove counterMoves[64][64];
+    // how often each quiet move (by player, start and end) caused a beta cutoff, minus how often it was tried without causing one
+    int history[2][64][64];
+
+    MoveHistory() { clear(); }
+    // forgets everything
+    void clear();
+    // forgets the killers (which are about the last search's plies) and halves the history, at the start of a new search
+    void age();
+
+    // records that the quiet move `move` caused a beta cutoff at `ply` with `depth` moves left to search, in reply to `previousMove`.
+    // `triedMoves` are the quiet moves that were searched before it without causing one
+    void updateQuiet(const int side, const int ply, const int depth, const PackedMove move, const PackedMove previousMove,
+                     const PackedMove* triedMoves, const int triedCount);
+};
+
+/*
+ * Hands out the legal moves of a position one at a time, in the order they are most likely to be best, so that alpha-beta
+ * search finds a cutoff as early as possible. It works in stages, and only sorts the moves of a stage once it reaches it,
+ * since a cutoff often comes before the later stages are needed:
+ *   1. the transposition table's best move for the position
+ *   2. captures and promotions that do not lose material (by `BitBoard::see`), the most valuable victim first, and the least
+ *      valuable attacker first among those (MVV-LVA)
+ *   3. the killer moves for this ply, then the counter-move to the previous move
+ *   4. the captures and promotions that lose material, in the order they were found
+ *   5. the rest of the quiet moves, by their history score
+ */
+class MovePicker {
+    enum class Stage { HashMove, ScoreCaptures, Captures, Killers, BadCaptures, Quiets, Done };
+
+    const BitBoard& board;
+    MoveList moves;
+    // the ordering score of each move in `moves`, filled in when its stage starts
+    int scores[256];
+    // the moves before this index have already been handed out (or moved out of the way)
+    int next = 0;
+    // the moves before this index are captures and promotions, and the rest are quiet moves
+    int captureCount = 0;
+    Stage stage = Stage::HashMove;
+    // the captures put aside during the `Captures` stage for losing material, and how many of them have been handed out
+    MoveList badCaptures;
+    int badCaptureIndex = 0;
+
+    const PackedMove hashMove;
+    // the killers and then the counter-move, which are tried in this order
+    PackedMove refutations[3];
+    int refutationIndex = 0;
+    const MoveHistory& moveHistory;
+    const int side;
+
+    // moves the highest scoring move in [next, end) to `next`, and hands it out
+    PackedMove pickBest(const int end);
+    // moves `move` (if it is in the quiet moves not yet handed out) to `next`, and returns if it did
+    bool takeQuiet(const PackedMove move);
+public:
+    // the killers and counter-move are taken from `moveHistory` now, and the history scores when the quiet moves are reached.
+    // `ply` and `previousMove` choose the killers and counter-move; an empty `previousMove` means there is no counter-move.
+    // with `capturesOnly`, only the moves from `BitBoard::generateCaptures` are handed out
+    MovePicker(const BitBoard& board, const PackedMove hashMove, const MoveHistory& moveHistory, const int ply, const PackedMove previousMove,
+               const bool capturesOnly = false);
+
+    // returns the next move, or an empty move (0) once every move has been handed out
+    PackedMove nextMove();
+    // returns if the last move handed out was a capture or promotion that loses material. Only more of these (and then quiet
+    // moves) can follow it
+    bool isBadCapture() const { return stage == Stage::BadCaptures; }
+    // the number of legal moves in the position
+    int size() const { return moves.size(); }
+
+    // the value of each piece offset (see the `Piece` enum) when ordering captures. The king is worth nothing here, since it can
+    // only capture a piece that is not defended, which makes it the safest attacker
+    static constexpr int pieceValues[6] = {0, 900, 330, 320, 500, 100};
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef PACKEDMOVE_H
+#define PACKEDMOVE_H
+
+#include <cstdint>
+#include <string>
+
+// A move packed into 16 bits, used by move generation, the search and the transposition table, so that move lists stay small
+// and two moves are the same exactly when their `data` is.
+// bits 0-5 store the starting position
+// bits 6-11 store the ending position
+// bits 12-15 store the kind of move (see `Flag`), so that making a move does not have to work out what it does:
+//     bit 14 is set for captures (including en passant), and bit 15 for promotions, whose lowest two flag bits give the piece
+struct PackedMove {
+    enum Flag : uint16_t {
+        Quiet = 0,
+        DoublePawnPush = 1,
+        KingSideCastle = 2,
+        QueenSideCastle = 3,
+        Capture = 4,
+        EnPassant = 5,
+        // add one of the promotion pieces below, and `Capture` if the promotion also captures
+        Promotion = 8
+    };
+    // the lowest two flag bits of a promotion, in the order knight, bishop, rook, queen, give the piece offset (see the `Piece` enum)
+    static constexpr int promotionPieces[4] = {3, 2, 4, 1};
+
+    uint16_t data;
+
+    PackedMove() = default;
+    PackedMove(const int start, const int end, const int flags = Flag::Quiet) : data{static_cast<uint16_t>(start | (end << 6) | (flags << 12))} {}
+
+    // returns the move promoting into the piece with offset `piece` (see the `Piece` enum), which must be a queen, bishop, knight, or rook
+    static PackedMove promotion(const int start, const int end, const int piece, const bool capture)
+    {
+        int pieceFlag = 0;
+        while (promotionPieces[pieceFlag] != piece) {
+            ++pieceFlag;
+        }
+        return {start, end, Flag::Promotion | (capture ? Flag::Capture : 0) | pieceFlag};
+    }
+
+    int getStart() const { return data & 0x3F; }
+    int getEnd() const { return (data >> 6) & 0x3F; }
+    int getFlags() const { return data >> 12; }
+    // returns the start and end positions without the flags, for matching a move given only by its tiles
+    uint16_t getSquares() const { return data & 0xFFF; }
+
+    bool isCapture() const { return getFlags() & Flag::Capture; }
+    bool isPromotion() const { return getFlags() & Flag::Promotion; }
+    bool isEnPassant() const { return getFlags() == Flag::EnPassant; }
+    bool isCastle() const { return getFlags() == Flag::KingSideCastle || getFlags() == Flag::QueenSideCastle; }
+    bool isDoublePawnPush() const { return getFlags() == Flag::DoublePawnPush; }
+    // returns the piece offset (see the `Piece` enum) that a pawn promotes into, or 0 if this is not a promotion
+    //     (0 is the king's offset, which a pawn can never promote into)
+    int getPromotion() const { return isPromotion() ? promotionPieces[getFlags() & 0x3] : 0; }
+
+    bool operator==(const PackedMove& other) const { return data == other.data; }
+
+    // returns the move in coordinate notation, such as `e2e4`, or `e7e8q` for a promotion
+    std::string toString() const
+    {
+        std::string result = {static_cast<char>('a' + getStart() % 8), static_cast<char>('1' + getStart() / 8),
+                              static_cast<char>('a' + getEnd() % 8), static_cast<char>('1' + getEnd() / 8)};
+        if (getPromotion()) {
+            result += "kqbnrp"[getPromotion()];
+        }
+        return result;
+    }
+};
+
+#endif
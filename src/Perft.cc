@@ -0,0 +1,214 @@
+#include "Perft.h"
+#include <chrono>
+
+const std::vector<Perft::ReferencePosition> Perft::referencePositions = {
+    {"start position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        {20, 400, 8902, 197281, 4865609, 119060324}},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        {48, 2039, 97862, 4085603, 193690690}},
+    {"rook endgame with en passant pins", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        {14, 191, 2812, 43238, 674624, 11030083}},
+    {"promotions and checks", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        {6, 264, 9467, 422333, 15833292}},
+    {"promotion with castling", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        {44, 1486, 62379, 2103487, 89941194}},
+    {"symmetric middlegame", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        {46, 2079, 89890, 3894594, 164075551}},
+};
+
+const std::vector<std::string> Perft::invalidPositions = {
+    "rnbq1bnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQ - 0 1",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQ1BNR b kq - 0 1",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBKKBNR w kq - 0 1",
+    "4k3/8/8/8/8/8/8/4k2K w - - 0 1",
+    // black to move can not be checking white
+    "4k3/8/8/8/8/8/8/4K2r b - - 0 1",
+    "4k3/8/8/8/1b6/8/8/4K3 b - - 0 1",
+    // the en passant tile must have been skipped by an enemy pawn that just moved two tiles
+    "4k3/8/8/3P4/8/8/8/4K3 w - e6 0 1",
+    "4k3/4p3/8/3Pp3/8/8/8/4K3 w - e6 0 1",
+    "4k3/8/4n3/3Pp3/8/8/8/4K3 w - e6 0 1",
+    "4k3/8/8/8/3pP3/4B3/8/4K3 b - e3 0 1",
+    // pawns can not be on the first or last rank
+    "4k2P/8/8/8/8/8/8/4K3 w - - 0 1",
+    "4k3/8/8/8/8/8/8/p3K3 b - - 0 1",
+};
+
+U64 Perft::countLeaves(BitBoard& board, const int depth)
+{
+    // there is no need to generate the last moves just to count them
+    if (depth == 1) {
+        return board.countLegalMoves();
+    }
+    MoveList moves;
+    board.generateMoves(moves);
+    U64 nodes = 0;
+    for (const auto move : moves) {
+        const Undo undo = board.makeMove(move);
+        nodes += countLeaves(board, depth - 1);
+        board.unmakeMove(move, undo);
+    }
+    return nodes;
+}
+
+U64 Perft::countLeavesByPositions(const BitBoard& board, const int depth)
+{
+    const auto nextPositions = board.generateValidNextPositions();
+    if (depth == 1) {
+        return nextPositions.size();
+    }
+    U64 nodes = 0;
+    for (const auto& nextPosition : nextPositions) {
+        nodes += countLeavesByPositions(*nextPosition, depth - 1);
+    }
+    return nodes;
+}
+
+bool Perft::checkMakeUnmake(BitBoard& board, const int depth, std::ostream& out)
+{
+    MoveList moves;
+    board.generateMoves(moves);
+    for (const auto move : moves) {
+        const BitBoard before{board};
+        const Undo undo = board.makeMove(move);
+        const bool madeCorrectly = board.hasConsistentIncrementalState();
+        const bool restOfLineCorrect = madeCorrectly && (depth <= 1 || checkMakeUnmake(board, depth - 1, out));
+        board.unmakeMove(move, undo);
+        if (!madeCorrectly) {
+            out << "  FAILED: the incremental state is wrong after making " << move.toString() << " in " << before.toFEN() << std::endl;
+            return false;
+        } else if (!restOfLineCorrect) {
+            return false;
+        } else if (!board.isIdenticalTo(before) || !board.hasConsistentIncrementalState()) {
+            out << "  FAILED: unmaking " << move.toString() << " did not restore " << before.toFEN() << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+U64 Perft::perft(const BitBoard& board, const int depth)
+{
+    if (depth <= 0) {
+        return 1;
+    }
+    BitBoard searchBoard{board};
+    return countLeaves(searchBoard, depth);
+}
+
+U64 Perft::divide(const BitBoard& board, const int depth, std::ostream& out)
+{
+    BitBoard searchBoard{board};
+    MoveList moves;
+    searchBoard.generateMoves(moves);
+
+    U64 total = 0;
+    for (const auto move : moves) {
+        const Undo undo = searchBoard.makeMove(move);
+        const U64 nodes = (depth <= 1) ? 1 : countLeaves(searchBoard, depth - 1);
+        searchBoard.unmakeMove(move, undo);
+        out << move.toString() << ": " << nodes << std::endl;
+        total += nodes;
+    }
+    out << std::endl << "moves: " << moves.size() << std::endl;
+    return total;
+}
+
+bool Perft::runSuite(const int maxDepth, std::ostream& out)
+{
+    using namespace std::chrono;
+    bool allPassed = true;
+    U64 totalNodes = 0;
+    double totalSeconds = 0;
+    for (const auto& reference : referencePositions) {
+        out << reference.name << " (" << reference.fen << ")" << std::endl;
+        const BitBoard board = *BitBoard::fromFEN(reference.fen);
+        const int depth = std::min<int>(maxDepth, reference.counts.size());
+        const auto start = steady_clock::now();
+        const U64 nodes = perft(board, depth);
+        const double seconds = duration<double>(steady_clock::now() - start).count();
+        totalNodes += nodes;
+        totalSeconds += seconds;
+
+        const U64 expected = reference.counts[depth - 1];
+        printResult(out, depth, nodes, seconds);
+        if (nodes != expected) {
+            out << "  FAILED: expected " << expected << std::endl;
+            allPassed = false;
+        }
+
+        // the boards from generateValidNextPositions must agree with the moves from generateMoves.
+        // this is much slower, so only check it to a shallow depth
+        const int shallowDepth = std::min(depth, 3);
+        const U64 positionNodes = countLeavesByPositions(board, shallowDepth);
+        if (positionNodes != reference.counts[shallowDepth - 1]) {
+            out << "  FAILED: generateValidNextPositions gave " << positionNodes << " at depth " << shallowDepth
+                << ", expected " << reference.counts[shallowDepth - 1] << std::endl;
+            allPassed = false;
+        }
+
+        // making and then unmaking a move must give back the exact board, and the hash keys and scores that are updated
+        // along the way must always match computing them from scratch
+        BitBoard checkBoard{board};
+        if (!checkMakeUnmake(checkBoard, shallowDepth, out)) {
+            allPassed = false;
+        }
+    }
+    for (const auto& fen : invalidPositions) {
+        if (BitBoard::fromFEN(fen)) {
+            out << "FAILED: accepted the invalid FEN " << fen << std::endl;
+            allPassed = false;
+        }
+    }
+    out << std::endl << "total:" << std::endl;
+    printResult(out, maxDepth, totalNodes, totalSeconds);
+    out << (allPassed ? "all positions passed" : "SOME POSITIONS FAILED") << std::endl;
+    return allPassed;
+}
+
+void Perft::printResult(std::ostream& out, const int depth, const U64 nodes, const double seconds)
+{
+    const U64 nodesPerSecond = (seconds > 0) ? static_cast<U64>(nodes / seconds) : 0;
+    out << "  perft(" << depth << ") = " << nodes << " in " << static_cast<int>(seconds * 1000) << " ms ("
+        << nodesPerSecond << " nodes/s)" << std::endl;
+}
+
+int Perft::runCommand(const std::vector<std::string>& args, std::ostream& out)
+{
+    const std::string startPosition = referencePositions[0].fen;
+    try {
+        if (!args.empty() && args[0] == "suite") {
+            const int maxDepth = (args.size() > 1) ? std::stoi(args[1]) : 4;
+            return runSuite(std::max(1, maxDepth), out) ? 0 : 1;
+        }
+
+        const bool isDivide = !args.empty() && args[0] == "divide";
+        const size_t depthIndex = isDivide ? 1 : 0;
+        if (args.size() <= depthIndex) {
+            out << "usage: chess perft [divide] <depth> [fen]" << std::endl
+                << "       chess perft suite [depth]" << std::endl;
+            return 1;
+        }
+        const int depth = std::stoi(args[depthIndex]);
+
+        // the FEN may have been passed as one argument, or split over several
+        std::string fen;
+        for (size_t i = depthIndex + 1; i < args.size(); ++i) {
+            fen += args[i] + " ";
+        }
+        const auto board = BitBoard::fromFEN(fen.empty() ? startPosition : fen);
+        if (!board) {
+            out << "invalid FEN: " << fen << std::endl;
+            return 1;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const U64 nodes = isDivide ? divide(*board, depth, out) : perft(*board, depth);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printResult(out, depth, nodes, seconds);
+        return 0;
+    } catch (const std::exception&) {
+        out << "invalid perft depth" << std::endl;
+        return 1;
+    }
+}
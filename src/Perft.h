@@ -0,0 +1,53 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "BitBoard.h"
+#include <string>
+#include <vector>
+#include <iostream>
+
+/*
+ * Perft ("performance test") counts every sequence of legal moves from a position to a fixed depth.
+ * Since the correct counts for many positions are well known, comparing against them checks move generation
+ * (castling, en passant, promotions, pins and checks), and timing them measures how fast it is.
+ * It is run with `./chess perft ...` (see `runCommand`), or `make perft` for the reference suite.
+ */
+class Perft {
+    // a position with its known perft counts, starting at depth 1
+    struct ReferencePosition {
+        std::string name;
+        std::string fen;
+        std::vector<U64> counts;
+    };
+    static const std::vector<ReferencePosition> referencePositions;
+    // FEN strings that `BitBoard::fromFEN` must reject, since searching them would be undefined
+    static const std::vector<std::string> invalidPositions;
+
+    // counts the leaves by making and unmaking moves on a single board, like the search does
+    static U64 countLeaves(BitBoard& board, const int depth);
+    // counts the leaves using the boards from `generateValidNextPositions`, to check it against `generateMoves`
+    static U64 countLeavesByPositions(const BitBoard& board, const int depth);
+    // makes and unmakes every sequence of moves up to `depth` on `board`, returning false (and printing the moves) as soon as
+    // a board after `makeMove` has incremental state that does not match a from-scratch computation, or `unmakeMove` does
+    // not give back exactly the board from before `makeMove`
+    static bool checkMakeUnmake(BitBoard& board, const int depth, std::ostream& out);
+
+    // prints a perft result along with how fast it was
+    static void printResult(std::ostream& out, const int depth, const U64 nodes, const double seconds);
+public:
+    // returns the number of leaves of the tree of legal moves from `board` that is `depth` moves deep
+    static U64 perft(const BitBoard& board, const int depth);
+    // prints the perft count below each legal move from `board`, then the total
+    static U64 divide(const BitBoard& board, const int depth, std::ostream& out);
+    // runs perft on each reference position to (at most) `maxDepth`, printing the results.
+    // returns true iff every count matched the known count.
+    static bool runSuite(const int maxDepth, std::ostream& out);
+
+    // runs a perft subcommand, returning the program's exit code. The arguments are one of:
+    //   <depth> [fen]         counts the leaves from the position (the starting position if no FEN is given)
+    //   divide <depth> [fen]  also prints the count below each move
+    //   suite [depth]         checks every reference position up to the depth (4 by default)
+    static int runCommand(const std::vector<std::string>& args, std::ostream& out);
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef SEARCHINFO_H
+#define SEARCHINFO_H
+
+#include "PackedMove.h"
+#include <cstdint>
+#include <vector>
+
+// what a computer player reports about its search after finishing each depth
+struct SearchInfo {
+    // the depth that was just finished
+    int depth = 0;
+    // the score of the position for the player to move, in hundredths of a pawn
+    int score = 0;
+    // if the score is a forced checkmate, the number of moves until it (negative if the player to move is the one getting mated), otherwise 0
+    int mateIn = 0;
+    // the positions searched and the time taken so far
+    uint64_t nodes = 0;
+    int milliseconds = 0;
+    // the line of play the search expects, starting with the move it would play
+    std::vector<PackedMove> principalVariation;
+    // the fraction of the main thread's evaluations in this search that found their pawns in its pawn hash (see PawnHash)
+    double pawnHashHitRate = 0;
+};
+
+#endif
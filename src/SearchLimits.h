@@ -0,0 +1,27 @@
+#ifndef SEARCHLIMITS_H
+#define SEARCHLIMITS_H
+
+#include <cstdint>
+
+// Limits on how long a computer player may think about a move. A value of 0 means that limit is not used.
+// If no limit is set at all, the computer searches to its default depth.
+struct SearchLimits {
+    // the maximum depth to search to
+    int depth = 0;
+    // the time to spend on each move, in milliseconds
+    int moveTime = 0;
+    // the time left on the computer's clock, and the time added to its clock after each of its moves, in milliseconds
+    int time = 0;
+    int increment = 0;
+    // the number of positions to search (as counted by the main search thread)
+    uint64_t nodes = 0;
+    // if true, search until told to stop, ignoring the default depth
+    bool infinite = false;
+    // if true, the search thinks on the opponent's time: the time limits do not start until `Computer::ponderHit`
+    bool ponder = false;
+
+    bool hasTimeLimit() const { return moveTime > 0 || time > 0; }
+    bool hasAnyLimit() const { return depth > 0 || hasTimeLimit() || nodes > 0 || infinite; }
+};
+
+#endif
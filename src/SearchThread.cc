@@ -0,0 +1,115 @@
+#include "SearchThread.h"
+
+SearchThread::SearchThread(Computer& computer): computer{computer}, thread{[this]() { run(); }} {}
+
+SearchThread::~SearchThread()
+{
+    stop();
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        quitting = true;
+    }
+    changed.notify_all();
+    thread.join();
+}
+
+void SearchThread::run()
+{
+    std::unique_lock<std::mutex> lock{mutex};
+    while (true) {
+        changed.wait(lock, [this]() { return hasJob || quitting; });
+        if (quitting) {
+            return;
+        }
+        hasJob = false;
+        const BitBoard searchBoard = board;
+        const SearchLimits searchLimits = limits;
+        const auto finished = onFinished;
+
+        lock.unlock();
+        const PackedMove move = computer.runSearch(searchBoard, searchLimits);
+        const PackedMove reply = (move.data == 0) ? PackedMove{} : computer.getPonderMove(move);
+        lock.lock();
+
+        // a search that ran out of moves to search before it was told how to end still has to wait
+        changed.wait(lock, [this]() { return !holding; });
+        bestMove = move;
+        ponderMove = reply;
+
+        if (finished) {
+            lock.unlock();
+            finished(move, reply);
+            lock.lock();
+        }
+        searching = false;
+        changed.notify_all();
+    }
+}
+
+void SearchThread::start(const BitBoard& newBoard, const SearchLimits& newLimits, std::function<void(PackedMove, PackedMove)> newOnFinished)
+{
+    stop();
+    std::unique_lock<std::mutex> lock{mutex};
+    changed.wait(lock, [this]() { return !searching; });
+
+    board = newBoard;
+    limits = newLimits;
+    onFinished = newOnFinished;
+    // the search is begun here rather than on the search thread, so that a `stop` right after this is never lost
+    computer.beginSearch(limits);
+    hasJob = true;
+    searching = true;
+    holding = limits.ponder || limits.infinite;
+    changed.notify_all();
+}
+
+void SearchThread::stop()
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    if (searching) {
+        computer.stop();
+        holding = false;
+        changed.notify_all();
+    }
+}
+
+void SearchThread::ponderHit()
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    if (searching && limits.ponder) {
+        limits.ponder = false;
+        computer.ponderHit();
+        holding = limits.infinite;
+        changed.notify_all();
+    }
+}
+
+PackedMove SearchThread::wait()
+{
+    std::unique_lock<std::mutex> lock{mutex};
+    changed.wait(lock, [this]() { return !searching; });
+    return bestMove;
+}
+
+bool SearchThread::isSearching()
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    return searching;
+}
+
+bool SearchThread::isPondering()
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    return searching && limits.ponder;
+}
+
+U64 SearchThread::getNodes() const
+{
+    return computer.getNodes();
+}
+
+PackedMove SearchThread::getPonderMove()
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    return ponderMove;
+}
@@ -0,0 +1,73 @@
+#ifndef SEARCHTHREAD_H
+#define SEARCHTHREAD_H
+
+#include "BitBoard.h"
+#include "Computer.h"
+#include "PackedMove.h"
+#include "SearchLimits.h"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/*
+ * Runs a `Computer`'s searches on a dedicated thread, so that whoever started a search (a controller reading input)
+ * stays free to stop it, check on its progress, or start the next one.
+ *
+ * A search started with `SearchLimits::ponder` thinks on the opponent's time about the position after the move we expect
+ * them to play. If they play it, `ponderHit` turns it into the real search without starting over; otherwise it is stopped.
+ * A ponder (or infinite) search never finishes on its own: it holds on to its move until `ponderHit` or `stop`.
+ */
+class SearchThread {
+    Computer& computer;
+
+    // guards everything below, and is waited on for both new searches and finished ones
+    std::mutex mutex;
+    std::condition_variable changed;
+    // the next search for the thread to run, if `hasJob`
+    BitBoard board;
+    SearchLimits limits;
+    std::function<void(PackedMove, PackedMove)> onFinished;
+    bool hasJob = false;
+    // true from `start` until the search has finished and `onFinished` has been called
+    bool searching = false;
+    // true while a finished search must keep its move to itself (see above)
+    bool holding = false;
+    bool quitting = false;
+    // the result of the last search
+    PackedMove bestMove{};
+    PackedMove ponderMove{};
+
+    // the thread itself, started last so that everything above exists before it runs
+    std::thread thread;
+
+    // runs searches as they are started until the thread is quitting
+    void run();
+public:
+    // `computer` must outlive this
+    explicit SearchThread(Computer& computer);
+    SearchThread(const SearchThread&) = delete;
+    SearchThread& operator=(const SearchThread&) = delete;
+    // stops any search and ends the thread
+    ~SearchThread();
+
+    // starts searching `board` in the background, stopping (and waiting for) any search already running.
+    // once the search ends, `onFinished` (if given) is called on the search thread with the best move and the reply we expect
+    // to it (either can be an empty move)
+    void start(const BitBoard& board, const SearchLimits& limits, std::function<void(PackedMove, PackedMove)> onFinished = {});
+    // tells the search to finish as soon as possible. It still reports the best move it has found.
+    void stop();
+    // turns a ponder search into the real one, whose time limits start now
+    void ponderHit();
+    // waits for the current search (if any) to finish, and returns the best move of the last search
+    PackedMove wait();
+
+    // the progress of the current search, which can be checked from any thread
+    bool isSearching();
+    bool isPondering();
+    U64 getNodes() const;
+    // the reply to the last best move that the last search expects
+    PackedMove getPonderMove();
+};
+
+#endif
@@ -0,0 +1,221 @@
+#include "UciController.h"
+#include <sstream>
+#include <algorithm>
+
+UciController::UciController(std::istream& in, std::ostream& out, const int hashSizeMB, const int threads):
+    in{in}, out{out}, hashSizeMB{hashSizeMB}, threads{threads}
+{
+    createComputer();
+}
+
+void UciController::sendLine(const std::string& line)
+{
+    std::lock_guard<std::mutex> lock{outputMutex};
+    out << line << std::endl;
+}
+
+void UciController::createComputer()
+{
+    // the old thread searches with the old computer, so it has to go first
+    searchThread.reset();
+    // the player only matters to levels 1-3; level 4 always searches for the player whose turn it is
+    computer = std::make_unique<Computer>(Player::White, 4, hashSizeMB, threads);
+    computer->setNullMovePruning(nullMovePruning);
+    computer->setLateMoveReductions(lateMoveReductions);
+    computer->setInfoCallback([this](const SearchInfo& info) {
+        std::ostringstream line;
+        line << "info depth " << info.depth;
+        if (info.mateIn != 0) {
+            line << " score mate " << info.mateIn;
+        } else {
+            line << " score cp " << info.score;
+        }
+        const int nodesPerSecond = (info.milliseconds > 0) ? static_cast<int>(info.nodes * 1000 / info.milliseconds) : 0;
+        line << " nodes " << info.nodes << " nps " << nodesPerSecond << " time " << info.milliseconds;
+        if (!info.principalVariation.empty()) {
+            line << " pv";
+            for (const auto move : info.principalVariation) {
+                line << " " << move.toString();
+            }
+        }
+        sendLine(line.str());
+        // UCI has no field for the pawn hash, so it is reported as a plain string
+        std::ostringstream pawnHashLine;
+        pawnHashLine << "info string pawn hash hit rate " << static_cast<int>(info.pawnHashHitRate * 1000) / 10.0 << "%";
+        sendLine(pawnHashLine.str());
+    });
+    searchThread = std::make_unique<SearchThread>(*computer);
+}
+
+void UciController::stopSearch()
+{
+    searchThread->stop();
+    searchThread->wait();
+}
+
+void UciController::run()
+{
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream args{line};
+        std::string cmd;
+        args >> cmd;
+
+        if (cmd == "uci") {
+            sendLine("id name ChessEngine");
+            sendLine("id author Matthew Pechen-Berg, Ross Cleary, and Kristy Lau");
+            sendLine("option name Hash type spin default " + std::to_string(Hash::defaultSizeMB) + " min 1 max 4096");
+            sendLine("option name Threads type spin default 1 min 1 max 256");
+            sendLine("option name Ponder type check default false");
+            sendLine("option name NullMove type check default true");
+            sendLine("option name LMR type check default true");
+            sendLine("uciok");
+        } else if (cmd == "isready") {
+            sendLine("readyok");
+        } else if (cmd == "setoption") {
+            stopSearch();
+            handleSetOption(args);
+        } else if (cmd == "ucinewgame") {
+            stopSearch();
+            computer->clearHash();
+        } else if (cmd == "position") {
+            stopSearch();
+            handlePosition(args);
+        } else if (cmd == "go") {
+            stopSearch();
+            handleGo(args);
+        } else if (cmd == "stop") {
+            stopSearch();
+        } else if (cmd == "ponderhit") {
+            searchThread->ponderHit();
+        } else if (cmd == "quit") {
+            break;
+        }
+        // UCI says to ignore unknown commands
+    }
+    stopSearch();
+}
+
+void UciController::handlePosition(std::istringstream& args)
+{
+    // position [startpos | fen <fen>] moves <move1> ... <movei>
+    // the position is built on its own, and only replaces `board` once the FEN and every move are known to be valid
+    hasPosition = false;
+    BitBoard newBoard;
+    std::string token;
+    args >> token;
+    if (token == "startpos") {
+        args >> token;
+    } else if (token == "fen") {
+        std::string fen;
+        while (args >> token && token != "moves") {
+            fen += token + " ";
+        }
+        const auto fenBoard = BitBoard::fromFEN(fen);
+        if (!fenBoard) {
+            sendLine("info string invalid fen " + fen);
+            return;
+        }
+        newBoard = *fenBoard;
+    } else {
+        sendLine("info string invalid position command");
+        return;
+    }
+
+    if (token == "moves") {
+        while (args >> token) {
+            MoveList moves;
+            newBoard.generateMoves(moves);
+            const auto move = std::find_if(moves.begin(), moves.end(), [&token](const PackedMove m) { return m.toString() == token; });
+            if (move == moves.end()) {
+                sendLine("info string illegal move " + token);
+                return;
+            }
+            newBoard.applyMove(*move);
+        }
+    }
+    board = newBoard;
+    hasPosition = true;
+}
+
+void UciController::handleGo(std::istringstream& args)
+{
+    // after an invalid `position` there is nothing to search, so there is no move to give either
+    if (!hasPosition) {
+        sendLine("info string no valid position to search");
+        sendLine("bestmove 0000");
+        return;
+    }
+
+    SearchLimits limits;
+    const bool whiteToMove = board.getCurrentPlayer() == Player::White;
+    std::string token;
+    while (args >> token) {
+        if (token == "infinite") {
+            limits.infinite = true;
+            continue;
+        } else if (token == "ponder") {
+            limits.ponder = true;
+            continue;
+        }
+        long long value = 0;
+        if (!(args >> value)) {
+            break;
+        }
+        if (token == "depth") {
+            limits.depth = static_cast<int>(value);
+        } else if (token == "movetime") {
+            limits.moveTime = static_cast<int>(value);
+        } else if (token == "nodes") {
+            limits.nodes = static_cast<uint64_t>(std::max(0ll, value));
+        } else if ((token == "wtime" && whiteToMove) || (token == "btime" && !whiteToMove)) {
+            // a clock can run slightly below 0 in some GUIs, but a time of 0 would mean no clock at all
+            limits.time = std::max(1, static_cast<int>(value));
+        } else if ((token == "winc" && whiteToMove) || (token == "binc" && !whiteToMove)) {
+            limits.increment = static_cast<int>(value);
+        }
+    }
+    // `go` on its own means to search until told to stop
+    if (!limits.hasAnyLimit() && !limits.ponder) {
+        limits.infinite = true;
+    }
+
+    searchThread->start(board, limits, [this](const PackedMove move, const PackedMove reply) {
+        // with no legal moves there is nothing to play, which UCI writes as `0000`
+        std::string line = "bestmove " + ((move.data == 0) ? std::string{"0000"} : move.toString());
+        if (reply.data != 0) {
+            line += " ponder " + reply.toString();
+        }
+        sendLine(line);
+    });
+}
+
+void UciController::handleSetOption(std::istringstream& args)
+{
+    // setoption name <id> [value <x>]
+    std::string token, name, value;
+    args >> token;
+    while (args >> token && token != "value") {
+        name += (name.empty() ? "" : " ") + token;
+    }
+    args >> value;
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+    try {
+        if (name == "hash") {
+            hashSizeMB = std::max(1, std::stoi(value));
+            createComputer();
+        } else if (name == "threads") {
+            threads = std::max(1, std::stoi(value));
+            createComputer();
+        } else if (name == "nullmove") {
+            nullMovePruning = (value == "true");
+            computer->setNullMovePruning(nullMovePruning);
+        } else if (name == "lmr") {
+            lateMoveReductions = (value == "true");
+            computer->setLateMoveReductions(lateMoveReductions);
+        }
+    } catch (const std::exception&) {
+        sendLine("info string invalid value for " + name);
+    }
+}
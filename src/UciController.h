@@ -0,0 +1,59 @@
+#ifndef UCICONTROLLER_H
+#define UCICONTROLLER_H
+
+#include "BitBoard.h"
+#include "Computer.h"
+#include "SearchLimits.h"
+#include "SearchThread.h"
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/*
+ * Runs the engine under the Universal Chess Interface (UCI), the text protocol that chess GUIs and match managers use
+ * to talk to engines. It is started with the `--uci` flag instead of the normal `ChessController`.
+ * It drives a level 4 `Computer` directly, without any display, so games run at full speed.
+ * Searches run on their own thread, so that commands like `stop` and `isready` are answered while the engine thinks.
+ * With `go ponder` the engine thinks on the opponent's time, and `ponderhit` turns that into the real search.
+ */
+class UciController {
+    std::istream& in;
+    std::ostream& out;
+
+    // the settings from `setoption`
+    int hashSizeMB;
+    int threads;
+    bool nullMovePruning = true;
+    bool lateMoveReductions = true;
+
+    // the search thread and the input thread both write to `out`, so each line is written while holding this
+    std::mutex outputMutex;
+    std::unique_ptr<Computer> computer;
+    // the position that `go` searches, as set by the last `position` command
+    BitBoard board;
+    // false once a `position` command was invalid, so that `go` does not search some other position in its place.
+    // the next valid `position` command sets it again
+    bool hasPosition = true;
+    // runs the searches of `computer`, and is remade with it
+    std::unique_ptr<SearchThread> searchThread;
+
+    // writes a whole line to `out`
+    void sendLine(const std::string& line);
+    // makes a computer with the current settings
+    void createComputer();
+    // stops the current search (if any) and waits for it to send its move
+    void stopSearch();
+
+    // handles the commands that need more than their name.
+    // `handlePosition` only changes `board` once the whole command is valid, and otherwise clears the position (see `hasPosition`)
+    void handlePosition(std::istringstream& args);
+    void handleGo(std::istringstream& args);
+    void handleSetOption(std::istringstream& args);
+public:
+    UciController(std::istream& in, std::ostream& out, const int hashSizeMB, const int threads);
+    // reads and answers commands until `quit` (or the end of the input)
+    void run();
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef UNDO_H
+#define UNDO_H
+
+#include <cstdint>
+#include "Piece.h"
+
+// The information lost when a move is made on a BitBoard, which `BitBoard::unmakeMove` needs to take it back.
+struct Undo {
+    // the piece that was captured, or `Piece::DarkNone` if nothing was captured
+    Piece capturedPiece;
+    // where the captured piece was (this differs from the move's ending position for en passant)
+    int capturedPosition;
+    // the BitBoard's temporal info from before the move
+    uint32_t temporalInfo;
+    // the BitBoard's hash key from before the move
+    uint64_t hashKey;
+    // the BitBoard's pawn key from before the move
+    uint64_t pawnKey;
+    // the BitBoard's halfmove clock from before the move
+    int halfmoveClock;
+};
+
+#endif
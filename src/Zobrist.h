@@ -0,0 +1,44 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+
+using U64 = uint64_t;
+
+/*
+ * Random keys for Zobrist hashing. A position's hash key is the XOR of the key of every piece on its tile,
+ * and of the key of every bit that is set in the BitBoard's temporal info. Since XOR undoes itself, the key
+ * can be updated incrementally by XOR-ing in the keys of only the pieces and bits that change.
+ * The keys come from a fixed SplitMix64 sequence, and are generated at compile time.
+ */
+struct ZobristKeys {
+    // indexed by [piece][position], with pieces in the same order as in the `Piece` enum
+    U64 pieceKeys[12][64];
+    // indexed by the bit position in `BitBoard::temporalInfo`
+    U64 temporalKeys[23];
+};
+
+constexpr ZobristKeys generateZobristKeys()
+{
+    ZobristKeys keys{};
+    U64 state = 0x5EEDC0FFEE123457ull;
+    auto next = [&state]() {
+        U64 z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    };
+    for (int piece = 0; piece < 12; ++piece) {
+        for (int position = 0; position < 64; ++position) {
+            keys.pieceKeys[piece][position] = next();
+        }
+    }
+    for (int bit = 0; bit < 23; ++bit) {
+        keys.temporalKeys[bit] = next();
+    }
+    return keys;
+}
+
+inline constexpr ZobristKeys zobrist = generateZobristKeys();
+
+#endif
@@ -2,19 +2,64 @@
 #include "BitBoard.h"
 #include "ChessSquares.h"
 #include "Computer.h"
+#include "EvalBench.h"
+#include "Perft.h"
+#include "UciController.h"
 #include <iostream>
 #include <fstream>
 #include <memory>
 #include <cstring>
+#include <cstdlib>
+#include <algorithm>
 
 int main(int argc, char *argv[]) 
 {
     srand(time(0));
+
+    // `chess perft ...` runs the move generation benchmark instead of a game
+    if (argc > 1 && std::strcmp(argv[1], "perft") == 0) {
+        return Perft::runCommand(std::vector<std::string>(argv + 2, argv + argc), std::cout);
+    }
+    // `chess evalbench ...` times computer4's evaluation instead
+    if (argc > 1 && std::strcmp(argv[1], "evalbench") == 0) {
+        return EvalBench::runCommand(std::vector<std::string>(argv + 2, argv + argc), std::cout);
+    }
+
     ChessController c;
+    SearchLimits limits;
+    int hashSizeMB = Hash::defaultSizeMB;
+    int threads = 1;
+    bool uci = false;
     for (int i = 0; i < argc; ++i) {
         if (std::strcmp(argv[i], "--auto") == 0) {
             c.setAutomatic();
+        } else if (std::strcmp(argv[i], "--ponder") == 0) {
+            c.setPonder();
+        } else if (std::strcmp(argv[i], "--uci") == 0) {
+            uci = true;
+        } else if (std::strcmp(argv[i], "--hash") == 0 && i + 1 < argc) {
+            hashSizeMB = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--movetime") == 0 && i + 1 < argc) {
+            limits.moveTime = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+            limits.time = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--inc") == 0 && i + 1 < argc) {
+            limits.increment = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            limits.depth = std::max(0, std::atoi(argv[++i]));
         }
     }
+
+    // in UCI mode, a GUI or match manager sets the limits for each move itself
+    if (uci) {
+        UciController uciController{std::cin, std::cout, hashSizeMB, threads};
+        uciController.run();
+        return 0;
+    }
+    c.setHashSize(hashSizeMB);
+    c.setThreads(threads);
+    c.setSearchLimits(limits);
     c.runController();
 }
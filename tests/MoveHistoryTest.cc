@@ -0,0 +1,41 @@
+#include "MovePicker.h"
+#include <iostream>
+#include <memory>
+
+// checks that `MoveHistory::age` halves the history score of every move of both players, and forgets the killers
+int main()
+{
+    // the tables are too big to want on the stack
+    auto moveHistory = std::make_unique<MoveHistory>();
+    const auto initialScore = [](const int side, const int start, const int end) { return (side ? -1 : 1) * (2 * (start * 64 + end) + 2); };
+    for (int side = 0; side < 2; ++side) {
+        for (int start = 0; start < 64; ++start) {
+            for (int end = 0; end < 64; ++end) {
+                moveHistory->history[side][start][end] = initialScore(side, start, end);
+            }
+        }
+    }
+    moveHistory->killers[0][0] = PackedMove{12, 28};
+
+    moveHistory->age();
+
+    bool passed = true;
+    for (int side = 0; side < 2; ++side) {
+        for (int start = 0; start < 64; ++start) {
+            for (int end = 0; end < 64; ++end) {
+                if (moveHistory->history[side][start][end] != initialScore(side, start, end) / 2) {
+                    std::cout << "FAILED: aging did not halve the history score of " << PackedMove{start, end}.toString()
+                              << " for side " << side << std::endl;
+                    passed = false;
+                }
+            }
+        }
+    }
+    if (moveHistory->killers[0][0].data != 0) {
+        std::cout << "FAILED: aging did not forget the killer moves" << std::endl;
+        passed = false;
+    }
+
+    std::cout << "MoveHistory aging: " << (passed ? "passed" : "FAILED") << std::endl;
+    return passed ? 0 : 1;
+}